@@ -30,9 +30,12 @@ license and credits. */
 #pragma once
 
 #include "Actuator.h"
+#include "DevicePool.h"
 
 class DigitalPinActuator ACTUATOR_BASE_CLASS_DECL
 {
+	DEVICE_POOL_ALLOCATED
+
   private:
 	bool invert;
 	uint8_t pin;
@@ -69,6 +69,63 @@ license and credits. */
 #define TEMP_SENSOR_CASCADED_FILTER 1
 #endif
 
+/**
+ * Calculate the beer slope with a least squares fit over the last 32 samples of the slow filter, instead of with the slope
+ * filter. The slope is then available seconds after a reset instead of minutes, but it is noisier once the slope filter
+ * has settled. Costs about 80 bytes of RAM per sensor.
+ */
+#ifndef TEMP_SENSOR_SLOPE_REGRESSION
+#define TEMP_SENSOR_SLOPE_REGRESSION 0
+#endif
+
+/**
+ * Keep a snapshot of the control state and filter outputs in RAM that is not cleared on reset, and resume from it when
+ * the controller is reset by a serial connection, instead of restarting with cold filters and compressor lockout timers.
+ */
+#ifndef BREWPI_WARM_RESTART
+#define BREWPI_WARM_RESTART 1
+#endif
+
+/**
+ * Use the VirtualLcd driver, which records each frame drawn on the display with a timestamp and counts characters and
+ * commands. The frame log is sent with the 'g' command. Meant for native (non-Arduino) builds.
+ */
+#ifndef BREWPI_VIRTUAL_LCD
+#define BREWPI_VIRTUAL_LCD !ARDUINO
+#endif
+
+/**
+ * Allocate devices from fixed capacity static pools instead of the heap, so installing and uninstalling devices does not
+ * fragment the heap. Pool occupancy is reported with the 'r' command.
+ */
+#ifndef BREWPI_DEVICE_POOLS
+#define BREWPI_DEVICE_POOLS 1
+#endif
+
+/**
+ * Paint free RAM at startup and report free RAM, the largest free block and the stack high-water mark with the 'r' command.
+ * Uses no RAM.
+ */
+#ifndef BREWPI_RAM_STATS
+#define BREWPI_RAM_STATS 1
+#endif
+
+/**
+ * Time the phases of the main loop and the lateness of the control tick, and report them with the 'm' command
+ * ('M' resets). Uses about 250 bytes of RAM, so it is meant for profiling builds.
+ */
+#ifndef BREWPI_LOOP_STATS
+#define BREWPI_LOOP_STATS 0
+#endif
+
+/**
+ * Check the Fixed point types for overflow. Overflows call fixedPointOverflow(), which asserts.
+ * Only meant for host builds: the checks use 64 bit arithmetic, which is too large and slow for AVR.
+ */
+#ifndef FIXED_POINT_CHECK_OVERFLOW
+#define FIXED_POINT_CHECK_OVERFLOW 0
+#endif
+
 #ifndef TEMP_CONTROL_STATIC
 #define TEMP_CONTROL_STATIC 1
 #endif
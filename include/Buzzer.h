@@ -31,8 +31,17 @@ license and credits. */
 
 #include "Brewpi.h"
 #include "Actuator.h"
+#include "Ticks.h"
 
 #if BREWPI_BUZZER
+
+// Beep patterns are PROGMEM lists of durations in units of BUZZER_STEP_MILLIS, alternating between on and off and
+// starting with on. A 0 ends the pattern.
+#define BUZZER_STEP_MILLIS 10
+
+extern const uint8_t BUZZER_STARTUP[]; // two beeps of 500 ms
+extern const uint8_t BUZZER_ALARM[];   // three short beeps and a pause, repeated while the alarm is active
+
 class Buzzer : public ValueActuator
 {
   public:
@@ -42,13 +51,23 @@ class Buzzer : public ValueActuator
 	void init(void);
 
 	/**
-	 * Performs a number of beeps synchronously.
-	 * @param numBeeps The number of beeps to emit
-	 * @param duration the duration of each beep
+	 * Starts playing a beep pattern, replacing the pattern that is playing.
+	 * The pattern is played by update(), so this returns immediately.
+	 * @param newPattern pattern in PROGMEM
 	 */
-	void beep(uint8_t numBeeps, uint16_t duration);
+	void play(const uint8_t *newPattern);
+	void stop(void);
+	bool isPlaying(void) { return pattern != NULL; }
+
+	// Advances the pattern. Called on each main loop iteration.
+	void update(void);
 
 	void setActive(bool active);
+
+  private:
+	const uint8_t *pattern; // next duration of the pattern, NULL when not playing
+	ticks_millis_t stepStart;
+	uint16_t stepDuration;
 };
 
 extern Buzzer buzzer;
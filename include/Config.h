@@ -117,6 +117,76 @@ license and credits. */
 //
 //////////////////////////////////////////////////////////////////////////
 
+//////////////////////////////////////////////////////////////////////////
+//
+// Flag to calculate the beer slope with a least squares fit instead of the slope filter
+//
+// #ifndef TEMP_SENSOR_SLOPE_REGRESSION
+// #define TEMP_SENSOR_SLOPE_REGRESSION 0
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Flag to resume control from a RAM snapshot after a reset (e.g. on serial connect)
+//
+// #ifndef BREWPI_WARM_RESTART
+// #define BREWPI_WARM_RESTART 1
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Flag to record the frames drawn on the display for native builds, reported by the 'g' command
+//
+// #ifndef BREWPI_VIRTUAL_LCD
+// #define BREWPI_VIRTUAL_LCD !ARDUINO
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Flag to allocate devices from static pools instead of the heap
+//
+// #ifndef BREWPI_DEVICE_POOLS
+// #define BREWPI_DEVICE_POOLS 1
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Flag to report RAM usage and the stack high-water mark with the 'r' command
+//
+// #ifndef BREWPI_RAM_STATS
+// #define BREWPI_RAM_STATS 1
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Flag to time the main loop phases, reported by the 'm' command
+//
+// #ifndef BREWPI_LOOP_STATS
+// #define BREWPI_LOOP_STATS 0
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Flag to check fixed point arithmetic for overflow (host builds only)
+//
+// #ifndef FIXED_POINT_CHECK_OVERFLOW
+// #define FIXED_POINT_CHECK_OVERFLOW 0
+// #endif
+//
+//////////////////////////////////////////////////////////////////////////
+
 //////////////////////////////////////////////////////////////////////////
 //
 // Flag to control implementation of TempControl as a static class.
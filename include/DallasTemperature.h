@@ -95,6 +95,7 @@ license and credits. */
 
 #include <inttypes.h>
 #include "OneWire.h"
+#include "DevicePool.h"
 
 // Model IDs
 #if REQUIRESDS18S20MODEL
@@ -148,6 +149,10 @@ typedef uint8_t DeviceAddress[8];
 
 class DallasTemperature
 {
+#if !REQUIRESNEW
+  DEVICE_POOL_ALLOCATED
+#endif
+
 public:
   DallasTemperature(OneWire *);
 
@@ -0,0 +1,138 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include <stddef.h>
+#include <stdint.h>
+
+struct DevicePoolStats
+{
+	uint8_t used;
+	uint8_t peak;	  // highest number of objects in use at the same time
+	uint8_t capacity;
+	uint8_t failed;	  // allocations that returned NULL because the pool was full
+};
+
+/*
+ * Fixed capacity storage for objects of at most Size bytes. Free slots are kept in a singly linked list that is threaded
+ * through the slots themselves, so allocate and release are O(1) and the pool needs no memory beyond its slots.
+ * Slots that have never been used are handed out in order, so a zero-initialized pool is ready to use without a
+ * constructor.
+ */
+template <size_t Size, uint8_t Capacity>
+class DevicePool
+{
+  public:
+	void *allocate(size_t size)
+	{
+		Slot *slot = freeList;
+		if (size > Size)
+		{
+			slot = NULL; // a derived class that does not declare its own pool
+		}
+		else if (slot)
+		{
+			freeList = slot->next;
+		}
+		else if (unused < Capacity)
+		{
+			slot = &slots[unused++];
+		}
+		if (!slot)
+		{
+			stats.failed++;
+			return NULL;
+		}
+		if (++stats.used > stats.peak)
+		{
+			stats.peak = stats.used;
+		}
+		return slot;
+	}
+
+	void release(void *p)
+	{
+		if (p)
+		{
+			Slot *slot = (Slot *)p;
+			slot->next = freeList;
+			freeList = slot;
+			stats.used--;
+		}
+	}
+
+	const DevicePoolStats &getStats()
+	{
+		stats.capacity = Capacity;
+		return stats;
+	}
+
+  private:
+	union Slot {
+		Slot *next;
+		uint32_t align;
+		uint8_t bytes[Size];
+	};
+
+	Slot slots[Capacity];
+	Slot *freeList;
+	uint8_t unused;
+	DevicePoolStats stats;
+};
+
+/*
+ * Declares class specific operator new and delete, so that the existing new and delete expressions for the class
+ * construct and destroy objects in its pool instead of on the heap. The pools are defined in DevicePools.cpp.
+ * operator new is noexcept, so the compiler checks for NULL before it runs the constructor: new returns NULL when the
+ * pool is full.
+ */
+#if BREWPI_DEVICE_POOLS
+#define DEVICE_POOL_ALLOCATED                         \
+  public:                                             \
+	static void *operator new(size_t size) noexcept; \
+	static void operator delete(void *p);
+#else
+#define DEVICE_POOL_ALLOCATED
+#endif
+
+#if BREWPI_DEVICE_POOLS
+enum DevicePoolId
+{
+	DEVICE_POOL_TEMP_SENSOR,		   // TempSensor, the filtered beer and fridge sensors
+	DEVICE_POOL_ONEWIRE_TEMP_SENSOR,   // OneWireTempSensor
+	DEVICE_POOL_DALLAS_TEMPERATURE,	   // DallasTemperature, one per OneWireTempSensor
+	DEVICE_POOL_PIN_ACTUATOR,		   // DigitalPinActuator
+	DEVICE_POOL_PIN_SENSOR,			   // DigitalPinSensor
+	NUM_DEVICE_POOLS
+};
+
+const DevicePoolStats &devicePoolStats(uint8_t pool);
+#endif
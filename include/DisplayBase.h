@@ -91,6 +91,8 @@ class Display
 
 	DISPLAY_METHOD void getLine(uint8_t lineNumber, char *buffer) DISPLAY_METHOD_PURE_VIRTUAL;
 
+	DISPLAY_METHOD uint16_t getContentVersion() DISPLAY_METHOD_PURE_VIRTUAL;
+
 	/*
 	 * When true, print content is not sent to the lcd panel, but only buffered.                                                                      
 	 */
@@ -99,6 +101,15 @@ class Display
 	DISPLAY_METHOD void resetBacklightTimer() DISPLAY_METHOD_PURE_VIRTUAL;
 
 	DISPLAY_METHOD void updateBacklight() DISPLAY_METHOD_PURE_VIRTUAL;
+
+	// called as often as possible to send pending output to the lcd panel
+	DISPLAY_METHOD void processQueue() DISPLAY_METHOD_PURE_VIRTUAL;
+
+	// called once per second to detect and repair a scrambled lcd panel
+	DISPLAY_METHOD void checkContent() DISPLAY_METHOD_PURE_VIRTUAL;
+
+	// force the given LCD_FIELD_* fields to be drawn on the next print, also when their value did not change
+	DISPLAY_METHOD void invalidate(uint8_t fields) DISPLAY_METHOD_PURE_VIRTUAL;
 };
 #endif
 
@@ -146,11 +157,19 @@ class NullDisplay DISPLAY_SUPERCLASS
 		buffer[20] = 0;
 	}
 
+	DISPLAY_METHOD uint16_t getContentVersion() { return 0; }
+
 	DISPLAY_METHOD void setBufferOnly(bool bufferOnly) {}
 
 	DISPLAY_METHOD void resetBacklightTimer() {}
 
 	DISPLAY_METHOD void updateBacklight() {}
+
+	DISPLAY_METHOD void processQueue() {}
+
+	DISPLAY_METHOD void checkContent() {}
+
+	DISPLAY_METHOD void invalidate(uint8_t fields) {}
 };
 
 /**
@@ -162,3 +181,16 @@ static const uint8_t LCD_FLAG_DISPLAY_ROOM = 0x01;
 	* When set, the room temp will automatically alternate between beer and room temp.
 	*/
 static const uint8_t LCD_FLAG_ALTERNATE_ROOM = 0x02;
+
+/**
+	* Fields of the display that are only formatted and drawn again when their value changed or they were invalidated.
+	* LCD_FIELD_FRIDGE_TEMP also shows the room temperature when LCD_FLAG_DISPLAY_ROOM is set.
+	*/
+static const uint8_t LCD_FIELD_BEER_TEMP = 0x01;
+static const uint8_t LCD_FIELD_BEER_SET = 0x02;
+static const uint8_t LCD_FIELD_FRIDGE_TEMP = 0x04;
+static const uint8_t LCD_FIELD_FRIDGE_SET = 0x08;
+static const uint8_t LCD_FIELD_MODE = 0x10;
+static const uint8_t LCD_FIELD_TIME = 0x20;
+static const uint8_t LCD_FIELD_TEMPERATURES = 0x0F;
+static const uint8_t LCD_FIELD_ALL = 0x3F;
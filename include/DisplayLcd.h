@@ -57,6 +57,9 @@ class LcdDisplay DISPLAY_SUPERCLASS
 	// print mode on the right location on the first line, after Mode:
 	DISPLAY_METHOD void printMode(void);
 
+	// force the fields to be drawn again on the next print, also when their value did not change
+	DISPLAY_METHOD void invalidate(uint8_t fields) { invalidFields |= fields; }
+
 	DISPLAY_METHOD void setDisplayFlags(uint8_t newFlags);
 	DISPLAY_METHOD uint8_t getDisplayFlags() { return flags; };
 
@@ -77,6 +80,9 @@ class LcdDisplay DISPLAY_SUPERCLASS
 
 	DISPLAY_METHOD void getLine(uint8_t lineNumber, char *buffer) { lcd.getLine(lineNumber, buffer); }
 
+	// changes whenever the content of the display changes, see PiLink::sendDisplaySnapshot()
+	DISPLAY_METHOD uint16_t getContentVersion() { return lcd.getContentVersion(); }
+
 	DISPLAY_METHOD void printAt_P(uint8_t x, uint8_t y, const char *text);
 
 	DISPLAY_METHOD void setBufferOnly(bool bufferOnly)
@@ -84,9 +90,17 @@ class LcdDisplay DISPLAY_SUPERCLASS
 		lcd.setBufferOnly(bufferOnly);
 	}
 
+	DISPLAY_METHOD LcdDriver &getLcd() { return lcd; }
+
 	DISPLAY_METHOD void resetBacklightTimer() { lcd.resetBacklightTimer(); }
 	DISPLAY_METHOD void updateBacklight() { lcd.updateBacklight(); }
 
+	// send pending commands and changed characters to the lcd, one byte per call
+	DISPLAY_METHOD void processQueue() { lcd.processQueue(); }
+
+	// check one line of the lcd against the shadow copy, replaces the periodic full reset of the lcd
+	DISPLAY_METHOD void checkContent(void);
+
 	// print a temperature
 	DISPLAY_METHOD void printTemperature(temperature temp);
 	DISPLAY_METHOD void printTemperatureAt(uint8_t x, uint8_t y, temperature temp);
@@ -96,8 +110,33 @@ class LcdDisplay DISPLAY_SUPERCLASS
 
 	DISPLAY_METHOD void printAt(uint8_t x, uint8_t y, char *text);
 
+#if BREWPI_LOOP_STATS
+	// number of field prints that were drawn and that were skipped because the field did not change
+	DISPLAY_METHOD uint16_t getFieldsDrawn() { return fieldsDrawn; }
+	DISPLAY_METHOD uint16_t getFieldsSkipped() { return fieldsSkipped; }
+	DISPLAY_METHOD void resetFieldStats() { fieldsDrawn = fieldsSkipped = 0; }
+#endif
+
   private:
+	// returns true when the field must be drawn, and marks it as drawn with the new value
+	DISPLAY_METHOD bool fieldChanged(uint8_t field, int16_t &shown, int16_t value);
+	DISPLAY_METHOD void printTemperatureField(uint8_t field, int16_t &shown, uint8_t x, uint8_t y, temperature temp);
+
 	DISPLAY_FIELD LcdDriver lcd;
 	DISPLAY_FIELD uint8_t stateOnDisplay;
 	DISPLAY_FIELD uint8_t flags;
+
+	// Values as they are on the display. Temperatures are kept as tempToShownTenths() returns them, so changes in the
+	// fraction bits that do not show up on the display do not cause a redraw.
+	DISPLAY_FIELD uint8_t invalidFields;
+	DISPLAY_FIELD int16_t shownBeerTemp;
+	DISPLAY_FIELD int16_t shownBeerSet;
+	DISPLAY_FIELD int16_t shownFridgeTemp;
+	DISPLAY_FIELD int16_t shownFridgeSet;
+	DISPLAY_FIELD int16_t shownMode;
+	DISPLAY_FIELD int16_t shownTime;
+#if BREWPI_LOOP_STATS
+	DISPLAY_FIELD uint16_t fieldsDrawn;
+	DISPLAY_FIELD uint16_t fieldsSkipped;
+#endif
 };
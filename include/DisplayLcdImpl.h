@@ -32,11 +32,19 @@ license and credits. */
 #include "SpiLcd.h"
 #include "OLEDFourBit.h"
 #include "NullLcdDriver.h"
+#include "VirtualLcd.h"
 
-#if BREWPI_EMULATE || !BREWPI_LCD || !ARDUINO
+#if BREWPI_VIRTUAL_LCD
+typedef VirtualLcd LcdDriver;
+#elif BREWPI_EMULATE || !BREWPI_LCD || !ARDUINO
 typedef NullLcdDriver LcdDriver;
 #elif !BREWPI_SHIFT_LCD
 typedef OLEDFourBit LcdDriver;
+#define LCD_DRIVER_TIMING_STATS BREWPI_LOOP_STATS // see OLEDTimingStats
 #else
 typedef SpiLcd LcdDriver;
 #endif
+
+#ifndef LCD_DRIVER_TIMING_STATS
+#define LCD_DRIVER_TIMING_STATS 0
+#endif
@@ -81,6 +81,19 @@ class EepromManager
 	static bool storeDevice(const DeviceConfig &config, uint8_t deviceIndex);
 
 	static uint8_t saveDefaultDevices();
+
+  private:
+	/**
+	 * Writes only the bytes in the eeprom that differ from source.
+	 */
+	static void updateBlock(eptr_t offset, const void *source, uint16_t size);
+
+	/**
+	 * Sets size bytes from offset to value, skipping bytes that already hold it.
+	 */
+	static void fillBlock(eptr_t offset, uint8_t value, uint16_t size);
+
+	static void updateByte(eptr_t offset, uint8_t value);
 };
 
 class EepromStream
@@ -0,0 +1,73 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Division by a constant as a multiplication with a scaled reciprocal: n / d == (n * m) >> s, with m = ceil(2^s / d).
+ *
+ * The AVR has no divide instruction. A 32 bit division is a library call (__udivmodsi4) that loops over the bits of the
+ * quotient, while the widening 32x32->64 bit multiplication below is a call to __umulsidi3, which uses the hardware MUL.
+ * The product is shifted right by 32 first, which only selects the upper 4 bytes, so no 64 bit shift loop is generated.
+ *
+ * Each function is exact over the input range given in its comment: m * d - 2^s must be at most 2^s / 2^bits for inputs
+ * below 2^bits. test/test_fast_divide checks each one against the division for every input in that range.
+ */
+
+template <uint32_t Multiplier, uint8_t Shift>
+inline uint32_t multiplyReciprocal(uint32_t n)
+{
+	return uint32_t((uint64_t(n) * Multiplier) >> 32) >> (Shift - 32);
+}
+
+// exact for all 32 bit values
+inline uint32_t divideBy9(uint32_t n)
+{
+	return multiplyReciprocal<0x38E38E39ul, 33>(n);
+}
+
+// exact for all 32 bit values, n / 1000 == (n / 8) / 125
+inline uint32_t divideBy1000(uint32_t n)
+{
+	return multiplyReciprocal<0x10624DD3ul, 35>(n >> 3);
+}
+
+// exact for n < 2^31
+inline uint32_t divideBy341(uint32_t n)
+{
+	return multiplyReciprocal<0x300C0301ul, 38>(n);
+}
+
+// exact for all 16 bit values. A 16x16->32 bit multiplication replaces the 16 bit division (__udivmodhi4).
+inline uint16_t divideBy60(uint16_t n)
+{
+	return uint16_t((uint32_t(n) * 0x8889u) >> 21);
+}
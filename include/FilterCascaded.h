@@ -42,7 +42,15 @@ class CascadedFilter
 {
   public:
 	// CascadedFilter implements a filter that consists of multiple second order secions.
-	FixedFilter sections[NUM_SECTIONS];
+	// The input history of each section is the output history of the section before it, so it is stored only once:
+	// history[0] holds the filter input, history[i + 1] holds the output of section i, which is the input of section i + 1.
+	// This needs (NUM_SECTIONS + 1) * 3 values instead of NUM_SECTIONS * 6 for separate FixedFilter sections.
+	// Each filter keeps its own state, there is no filter bank that advances many filters at once: the firmware runs one
+	// sample per second through the few filters of its two sensors, and the AVR has no vector instructions.
+	temperature_precise history[NUM_SECTIONS + 1][3];
+	// all sections share the same coefficients
+	uint8_t a;
+	uint8_t b;
 
   public:
 	CascadedFilter();
@@ -51,21 +59,19 @@ class CascadedFilter
 	void setCoefficients(uint8_t bValue);
 	temperature add(temperature val); // adds a value and returns the most recent filter output
 	temperature_precise addDoublePrecision(temperature_precise val);
+	// adds the same value count times, as if it was sampled count times. Used to catch up after missed samples.
+	// Long runs are computed in closed form, see FixedFilter::advanceHeldInput.
+	void addN(temperature val, uint8_t count);
+	void addNDoublePrecision(temperature_precise val, uint8_t count);
 	temperature readInput(void); // returns the most recent filter input
 
 	temperature readOutput(void)
 	{
-		return sections[NUM_SECTIONS - 1].readOutput(); // return output of last section
+		return tempPreciseToRegular(history[NUM_SECTIONS][0]); // return output of last section
 	}
 	temperature_precise readOutputDoublePrecision(void);
 	temperature_precise readPrevOutputDoublePrecision(void);
 
-	temperature detectPosPeak(void)
-	{
-		return sections[NUM_SECTIONS - 1].detectPosPeak(); // detect peaks in last section
-	}
-	temperature detectNegPeak(void)
-	{
-		return sections[NUM_SECTIONS - 1].detectNegPeak(); // detect peaks in last section
-	}
+	temperature detectPosPeak(void); // detect peaks in last section
+	temperature detectNegPeak(void); // detect peaks in last section
 };
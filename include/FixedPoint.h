@@ -0,0 +1,193 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include <stdint.h>
+
+#if FIXED_POINT_CHECK_OVERFLOW
+#include <assert.h>
+
+// called when an operation on a Fixed value overflows. Only used in host builds, AVR has no room for the checks.
+inline void fixedPointOverflow(void)
+{
+	assert(!"fixed point overflow");
+}
+typedef int64_t fixed_wide_t; // wide enough to detect overflow of all operations
+#else
+typedef int32_t fixed_wide_t; // same width as the long arithmetic it replaces
+#endif
+
+// selects the smallest signed integer type that holds Bits bits
+template <bool Fits8, bool Fits16>
+struct FixedStorageSelect
+{
+	typedef int32_t type;
+};
+template <>
+struct FixedStorageSelect<false, true>
+{
+	typedef int16_t type;
+};
+template <>
+struct FixedStorageSelect<true, true>
+{
+	typedef int8_t type;
+};
+template <uint8_t Bits>
+struct FixedStorage
+{
+	typedef typename FixedStorageSelect<(Bits <= 8), (Bits <= 16)>::type type;
+};
+
+// shifts left by Shift bits when Shift is positive, right (rounding down) when it is negative. Shift is known at compile
+// time, so this is a single constant shift. The multiplication is a shift too, but keeps left shifts of negative values defined.
+template <int8_t Shift>
+constexpr fixed_wide_t fixedShift(fixed_wide_t value)
+{
+	return Shift >= 0 ? value * (fixed_wide_t(1) << (Shift >= 0 ? Shift : 0)) : value >> (Shift < 0 ? -Shift : 0);
+}
+
+/*
+ * Fixed<IntBits, FracBits, Reserved> is a signed fixed point number with IntBits integer bits (including the sign bit) and
+ * FracBits fraction bits. It is stored in the smallest integer type that holds IntBits + FracBits bits, so it has the
+ * same size and layout as the plain integer typedefs in TemperatureFormats.h, which it wraps.
+ * The lowest Reserved raw values are markers instead of numbers (INVALID_TEMP and DISABLED_TEMP for temperatures).
+ * Saturating conversions never produce them.
+ *
+ * All conversions shift by a number of bits that is known at compile time, so they compile to the same code as the shift
+ * macros. Addition and subtraction wrap like the integer type. With FIXED_POINT_CHECK_OVERFLOW, which is meant for host
+ * builds, results that do not fit call fixedPointOverflow() instead. In a constant expression, that is a compile error.
+ */
+template <uint8_t IntBits, uint8_t FracBits, uint8_t Reserved = 0>
+class Fixed
+{
+  public:
+	typedef typename FixedStorage<IntBits + FracBits>::type raw_t;
+	static const uint8_t intBits = IntBits;
+	static const uint8_t fracBits = FracBits;
+
+	constexpr Fixed() : value(0) {}
+
+	static constexpr Fixed fromRaw(raw_t raw) { return Fixed(raw, RawTag()); }
+	static constexpr Fixed fromInt(int16_t i) { return fromWide(fixedShift<FracBits>(i)); }
+
+	// the nearest value, rounding ties away from zero, limited to the range. Meant for constants: with an argument that is
+	// not known at compile time, it pulls in the floating point library.
+	static constexpr Fixed fromDouble(double d) { return fromScaledDouble(d * double(fixed_wide_t(1) << FracBits)); }
+
+	static constexpr raw_t maxRaw() { return raw_t((uint32_t(1) << (IntBits + FracBits - 1)) - 1); }
+	static constexpr raw_t minRaw() { return raw_t(-fixed_wide_t(maxRaw()) - 1 + Reserved); }
+
+	constexpr raw_t raw() const { return value; }
+
+	// converts to another format. Dropped fraction bits are rounded down, like a right shift.
+	template <class To>
+	constexpr To convert() const
+	{
+		return To::fromWide(fixedShift<int8_t(To::fracBits) - int8_t(FracBits)>(value));
+	}
+
+	// converts to another format, and limits the result to the range of that format
+	template <class To>
+	constexpr To saturate() const
+	{
+		return To::fromWideSaturated(fixedShift<int8_t(To::fracBits) - int8_t(FracBits)>(value));
+	}
+
+	// full product of both operands. The result type has room for all bits, so it cannot overflow.
+	template <uint8_t IntBits2, uint8_t FracBits2, uint8_t Reserved2>
+	constexpr Fixed<IntBits + IntBits2, FracBits + FracBits2> operator*(Fixed<IntBits2, FracBits2, Reserved2> other) const
+	{
+		static_assert(IntBits + IntBits2 + FracBits + FracBits2 <= 32, "product does not fit in 32 bits, use multiply<Result>");
+		return Fixed<IntBits + IntBits2, FracBits + FracBits2>::fromRaw(fixed_wide_t(value) * other.raw());
+	}
+
+	// product in 32 bits, converted to Result and limited to its range
+	template <class Result, uint8_t IntBits2, uint8_t FracBits2, uint8_t Reserved2>
+	constexpr Result multiply(Fixed<IntBits2, FracBits2, Reserved2> other) const
+	{
+		return Result::fromWideSaturated(fixedShift<int8_t(Result::fracBits) - int8_t(FracBits + FracBits2)>(
+			fixedProduct(fixed_wide_t(value) * other.raw())));
+	}
+
+	constexpr Fixed operator+(Fixed other) const { return fromWide(fixed_wide_t(value) + other.value); }
+	constexpr Fixed operator-(Fixed other) const { return fromWide(fixed_wide_t(value) - other.value); }
+	constexpr Fixed operator-() const { return fromWide(-fixed_wide_t(value)); }
+	constexpr Fixed operator>>(uint8_t bits) const { return fromRaw(raw_t(value >> bits)); }
+
+	Fixed &operator+=(Fixed other) { return *this = *this + other; }
+	Fixed &operator-=(Fixed other) { return *this = *this - other; }
+
+	constexpr bool operator==(Fixed other) const { return value == other.value; }
+	constexpr bool operator!=(Fixed other) const { return value != other.value; }
+	constexpr bool operator<(Fixed other) const { return value < other.value; }
+	constexpr bool operator<=(Fixed other) const { return value <= other.value; }
+	constexpr bool operator>(Fixed other) const { return value > other.value; }
+	constexpr bool operator>=(Fixed other) const { return value >= other.value; }
+
+	// wraps a result that was calculated with more bits. With overflow checks enabled, it must fit.
+	static constexpr Fixed fromWide(fixed_wide_t wide)
+	{
+		return (FIXED_POINT_CHECK_OVERFLOW && (wide > maxRaw() || wide < minRaw())) ? overflow(wide) : fromRaw(raw_t(wide));
+	}
+
+	static constexpr Fixed fromWideSaturated(fixed_wide_t wide)
+	{
+		return fromRaw(wide > maxRaw() ? maxRaw() : wide < minRaw() ? minRaw() : raw_t(wide));
+	}
+
+  private:
+	struct RawTag
+	{
+	};
+	constexpr Fixed(raw_t raw, RawTag) : value(raw) {}
+
+	static constexpr Fixed fromScaledDouble(double scaled)
+	{
+		return fromRaw(scaled + 0.5 >= maxRaw() ? maxRaw() : scaled - 0.5 <= minRaw() ? minRaw() : raw_t(scaled < 0 ? scaled - 0.5 : scaled + 0.5));
+	}
+
+	static Fixed overflow(fixed_wide_t wide)
+	{
+#if FIXED_POINT_CHECK_OVERFLOW
+		fixedPointOverflow();
+#endif
+		return fromRaw(raw_t(wide));
+	}
+
+	// products are calculated in 32 bits, as the long arithmetic they replace. With overflow checks, they must fit.
+	static constexpr fixed_wide_t fixedProduct(fixed_wide_t product)
+	{
+		return (FIXED_POINT_CHECK_OVERFLOW && (product > INT32_MAX || product < INT32_MIN)) ? (overflow(0), product) : product;
+	}
+
+	raw_t value;
+};
@@ -0,0 +1,195 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include "Ticks.h"
+#include <stdint.h>
+
+// Flags of a queued byte. The low bits hold the number of milliseconds the display needs after receiving it.
+#define LCD_QUEUE_DATA 0x80								// RS high: character or CGRAM data, otherwise a command
+#define LCD_QUEUE_NIBBLE 0x40							// only the low 4 bits are sent, used while initializing in 8 bit mode
+#define LCD_QUEUE_NOP (LCD_QUEUE_DATA | LCD_QUEUE_NIBBLE) // nothing is sent, only the delay is applied
+#define LCD_QUEUE_DELAY_MASK 0x3F
+
+#ifndef LCD_COMMAND_QUEUE_SIZE
+#define LCD_COMMAND_QUEUE_SIZE 24
+#endif
+// Entries that must still be free after the initialization sequence of a driver, so that the commands that follow it
+// before it has been sent do not make enqueue() wait for the display. Checked by the drivers with static_assert.
+#define LCD_COMMAND_QUEUE_HEADROOM 8
+
+// The display cursor position is not known, the next character is preceded by an address command
+#define LCD_ADDRESS_UNKNOWN 0xFF
+
+/*
+ * LcdCommandQueue holds everything that still has to be sent to a character display, so the drivers can send one
+ * byte per main loop iteration instead of blocking on the delays the display needs.
+ * Commands (including the initialization sequence) are kept in order in a small ring buffer. Characters are not queued:
+ * the driver marks the cell of its shadow copy as changed and sends the current content of changed cells when no
+ * commands are pending. A cell that changes several times before it is sent is only sent once.
+ */
+class LcdCommandQueue
+{
+  public:
+	// Drop all pending commands and changed cells, used when the display is initialized again
+	void reset()
+	{
+		head = 0;
+		count = 0;
+		clearChanged();
+		address = LCD_ADDRESS_UNKNOWN;
+		holdOff(0);
+	}
+
+	bool push(uint8_t value, uint8_t flags)
+	{
+		if (count >= LCD_COMMAND_QUEUE_SIZE)
+		{
+			return false;
+		}
+		uint8_t index = head + count;
+		if (index >= LCD_COMMAND_QUEUE_SIZE)
+		{
+			index -= LCD_COMMAND_QUEUE_SIZE;
+		}
+		queuedValues[index] = value;
+		queuedFlags[index] = flags;
+		count++;
+		return true;
+	}
+
+	bool pop(uint8_t &value, uint8_t &flags)
+	{
+		if (count == 0)
+		{
+			return false;
+		}
+		value = queuedValues[head];
+		flags = queuedFlags[head];
+		if (++head >= LCD_COMMAND_QUEUE_SIZE)
+		{
+			head = 0;
+		}
+		count--;
+		return true;
+	}
+
+	// true when the display had the time it needs for the previously sent byte
+	bool ready()
+	{
+		return ticks.micros() - sentAt >= waitMicros;
+	}
+
+	// Don't send anything for the given number of milliseconds
+	void holdOff(uint16_t millis)
+	{
+		sentAt = ticks.micros();
+		waitMicros = millis * 1000ul;
+	}
+
+	// Record that a byte was sent: start its delay and follow the cursor of the display
+	void sent(uint8_t value, uint8_t flags, bool autoIncrement)
+	{
+		if ((flags & LCD_QUEUE_NOP) == LCD_QUEUE_DATA)
+		{
+			// the display only moves its cursor to the next address in left to right mode without shifting
+			address = (autoIncrement && address != LCD_ADDRESS_UNKNOWN) ? address + 1 : LCD_ADDRESS_UNKNOWN;
+		}
+		else if (flags & LCD_QUEUE_NIBBLE)
+		{
+			// (re)initialization of the interface, a half received byte could have been any command
+			address = LCD_ADDRESS_UNKNOWN;
+		}
+		else if (value & 0x80) // set DDRAM address
+		{
+			address = value & 0x7F;
+		}
+		else if (value & 0x40 || (value & 0xF0) == 0x10) // set CGRAM address or cursor/display shift
+		{
+			address = LCD_ADDRESS_UNKNOWN;
+		}
+		else if (value == 0x01 || value == 0x02) // clear or return home
+		{
+			address = 0;
+		}
+		holdOff(flags & LCD_QUEUE_DELAY_MASK);
+	}
+
+	uint8_t displayAddress() const { return address; }
+	void invalidateAddress() { address = LCD_ADDRESS_UNKNOWN; }
+
+	void markChanged(uint8_t line, uint8_t pos) { changed[line] |= uint32_t(1) << pos; }
+	void markSent(uint8_t line, uint8_t pos) { changed[line] &= ~(uint32_t(1) << pos); }
+	void markLineChanged(uint8_t line) { changed[line] = 0xFFFFF; } // all 20 cells
+	void clearChanged()
+	{
+		for (uint8_t i = 0; i < 4; i++)
+		{
+			changed[i] = 0;
+		}
+	}
+
+	// Find the first changed cell. Cells are returned in display order, so runs of changes need one address command.
+	bool nextChanged(uint8_t &line, uint8_t &pos) const
+	{
+		for (line = 0; line < 4; line++)
+		{
+			uint32_t bits = changed[line];
+			if (bits)
+			{
+				for (pos = 0; !(bits & 1); pos++)
+				{
+					bits >>= 1;
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool commandsPending() const { return count != 0; }
+
+	// true when all commands and changed characters are on the display
+	bool idle() const
+	{
+		return count == 0 && !(changed[0] | changed[1] | changed[2] | changed[3]);
+	}
+
+  private:
+	uint8_t queuedValues[LCD_COMMAND_QUEUE_SIZE];
+	uint8_t queuedFlags[LCD_COMMAND_QUEUE_SIZE];
+	uint8_t head;
+	uint8_t count;
+	uint8_t address;	// DDRAM address of the cursor on the display, to skip redundant address commands
+	uint32_t changed[4]; // bit per cell of the shadow copy that differs from the display
+	ticks_micros_t sentAt;
+	uint32_t waitMicros;
+};
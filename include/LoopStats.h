@@ -0,0 +1,104 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include "Ticks.h"
+
+#if BREWPI_LOOP_STATS
+
+// Parts of brewpiLoop() that are timed. The control tick phases run once per second, receive runs on every iteration.
+enum LoopPhase
+{
+	LOOP_PHASE_TEMPERATURES, // tempControl.updateTemperatures()
+	LOOP_PHASE_PEAKS,		 // tempControl.detectPeaks()
+	LOOP_PHASE_PID,			 // tempControl.updatePID()
+	LOOP_PHASE_STATE,		 // tempControl.updateState()
+	LOOP_PHASE_OUTPUTS,		 // tempControl.updateOutputs()
+	LOOP_PHASE_UI,			 // ui.update()
+	LOOP_PHASE_RECEIVE,		 // piLink.receive()
+	LOOP_TICK_LATENESS,		 // how much later than 1 s after the previous control tick a control tick started
+	NUM_LOOP_PHASES
+};
+
+// Bucket 0 counts durations below 32 us, bucket i counts [2^(i+4), 2^(i+5)) us, the last bucket everything above.
+#define LOOP_STATS_BUCKETS 12
+
+struct LoopPhaseStats
+{
+	ticks_micros_t min;
+	ticks_micros_t max;
+	uint32_t sum; // sum and count are halved together when either would overflow, which keeps the mean
+	uint16_t count;
+	uint8_t buckets[LOOP_STATS_BUCKETS]; // all buckets are halved when one is full, which keeps the shape of the histogram
+};
+
+/*
+ * LoopStats keeps min/max/mean and a log2 histogram of the duration of each loop phase in a static table.
+ * Durations are measured with ticks.micros(), which has a resolution of 4 us on a 16 MHz AVR.
+ */
+class LoopStats
+{
+  public:
+	static void record(uint8_t phase, ticks_micros_t duration);
+	// called at the start of each control tick to record the lateness of the tick
+	static void controlTick(void);
+	static void reset(void);
+
+	static const LoopPhaseStats &get(uint8_t phase) { return stats[phase]; }
+	static const char *name(uint8_t phase); // PROGMEM
+
+  private:
+	static LoopPhaseStats stats[NUM_LOOP_PHASES];
+	static ticks_micros_t lastControlTick;
+};
+
+// Records the time from construction to destruction as a duration of the phase
+class LoopPhaseTimer
+{
+  public:
+	LoopPhaseTimer(uint8_t phase) : phase(phase), start(ticks.micros()) {}
+	~LoopPhaseTimer() { LoopStats::record(phase, ticks.micros() - start); }
+
+  private:
+	uint8_t phase;
+	ticks_micros_t start;
+};
+
+#define LOOP_TIMED(phase, call)      \
+	do                               \
+	{                                \
+		LoopPhaseTimer timer(phase); \
+		call;                        \
+	} while (0)
+
+#else
+#define LOOP_TIMED(phase, call) call
+#endif
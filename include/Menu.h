@@ -38,14 +38,17 @@ license and credits. */
 #if BREWPI_MENU
 
 #include "TemperatureFormats.h"
+#include "Ticks.h"
+#include "ModeControl.h"
 
+// The page of the menu that is shown. The menu is ticked from UI::ticks(), so it never blocks the main loop.
 enum menuPages
 {
-	MENU_TOP,
-	MENU_PROFILE_SETTING,
-	MENU_BEER_SETTING,
-	MENU_FRIDGE_SETTING,
-	MENU_PROFILE
+	MENU_NONE,			 // menu not active
+	MENU_TOP,			 // pick the setting to change: mode, beer or fridge setting
+	MENU_MODE,			 // pick the control mode
+	MENU_BEER_SETTING,	 // pick the beer temperature setting
+	MENU_FRIDGE_SETTING, // pick the fridge temperature setting
 };
 
 class Menu
@@ -56,12 +59,31 @@ class Menu
 	static void pickMode(void);
 	static void pickBeerSetting(void);
 	static void pickFridgeSetting(void);
-	static void initRotaryWithTemp(temperature oldSetting);
+
+	// handle encoder input, blinking and timeout of the active page. Called on each main loop iteration.
+	static void update(void);
+
+	static bool isActive(void) { return page != MENU_NONE; }
 
 	~Menu(){};
 
   private:
-	static void pickSettingToChangeLoop();
+	static void pickTempSetting(menuPages newPage, temperature oldSetting);
+	static void showPage(menuPages newPage);
+	static void blink(bool visible);
+	static void changed(void);
+	static void selected(void);
+	static void cancel(void);
+	static void close(void);
+
+	static menuPages page;
+	static bool blinkVisible;
+	static uint16_t lastChangeTime;		  // seconds, for the timeout
+	static ticks_millis_t blinkStartTime; // start of the current blink period
+	static uint8_t oldDisplayFlags;		  // restored when the menu is closed
+	static control_mode_t oldMode;		  // restored when picking the mode times out
+	static control_mode_t pickedMode;	  // last mode set while picking, to detect a change over serial
+	static temperature pickedTemp;
 };
 
 extern Menu menu;
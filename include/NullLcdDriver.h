@@ -77,6 +77,9 @@ class NullLcdDriver : public Print
 	// copy a line from the shadow copy to a string buffer and correct the degree sign
 	void getLine(uint8_t lineNumber, char *buffer);
 
+	// incremented on each change of the shadow copy, so a reader can tell whether the content changed since it last looked
+	uint16_t getContentVersion(void) const { return _contentVersion; }
+
 	void readContent(void); // read the content from the display to the shadow copy buffer
 
 	void command(uint8_t);
@@ -84,6 +87,9 @@ class NullLcdDriver : public Print
 
 	void setBufferOnly(bool bufferOnly) { _bufferOnly = bufferOnly; }
 
+	void processQueue(void) {}
+	bool checkContent(void) { return false; }
+
 	void resetBacklightTimer(void);
 
 	void updateBacklight(void);
@@ -102,7 +108,7 @@ class NullLcdDriver : public Print
 
 	using Print::write;
 
-  private:
+  protected:
 	uint8_t _currline;
 	uint8_t _currpos;
 	uint8_t _numlines;
@@ -110,4 +116,5 @@ class NullLcdDriver : public Print
 	bool _bufferOnly;
 
 	char content[4][21]; // always keep a copy of the display content in this variable
+	uint16_t _contentVersion;
 };
@@ -33,6 +33,7 @@ license and credits. */
 #include <inttypes.h>
 #include "Print.h"
 #include "Pins.h"
+#include "LcdCommandQueue.h"
 
 // commands
 #define LCD_CLEARDISPLAY 0x01
@@ -72,6 +73,53 @@ license and credits. */
 #define LCD_ENGLISH_RUSSIAN 0x02
 #define LCD_WESTERN_EUROPEAN_2 0x03
 
+// Time allowed for the busy flag to clear. When it is still set after this for OLED_BUSY_TIMEOUT_LIMIT bytes in a row,
+// it is assumed that it cannot be read and fixed delays are used instead.
+#define OLED_BUSY_TIMEOUT_MICROS 10000
+#define OLED_BUSY_TIMEOUT_LIMIT 3
+// After sending a byte the busy flag is polled for this long, slower commands are polled again from processQueue()
+#define OLED_BUSY_SPIN_MICROS 200
+// Fixed delays in ms, only used when the busy flag cannot be read
+#define OLED_BYTE_DELAY 1
+#define OLED_CLEAR_DELAY 7
+// Fixed delay in us before reading a character, only used when the busy flag cannot be read. This is the delay that was
+// used for every read before the busy flag was polled.
+#define OLED_READ_DELAY_MICROS 600
+
+// Bytes queued by begin() and the clear() of LcdDisplay::init(): 9 by initInterface(), 6 more by begin() and 1 clear
+#define OLED_INIT_QUEUE_LENGTH 16
+static_assert(OLED_INIT_QUEUE_LENGTH + LCD_COMMAND_QUEUE_HEADROOM <= LCD_COMMAND_QUEUE_SIZE,
+			  "the OLED initialization sequence does not fit in the LCD command queue");
+
+// Kinds of bytes for which the time until the busy flag clears is recorded
+enum OLEDTimingClass
+{
+	OLED_TIMING_CLEAR,	 // clear display and return home
+	OLED_TIMING_COMMAND, // other commands
+	OLED_TIMING_DATA,	 // characters and CGRAM data
+	OLED_TIMING_CLASSES,
+	OLED_NOT_BUSY = OLED_TIMING_CLASSES
+};
+
+// Result of polling the busy flag
+enum OLEDBusyStatus
+{
+	OLED_BUSY,				  // still set when the time was up
+	OLED_READY_AT_FIRST_READ, // clear when it was first read
+	OLED_READY_AFTER_POLLING, // seen set, then clear
+};
+
+// Only bytes for which the busy flag was polled without a break from the main loop are counted, so the time is the
+// controller time. Bytes that were done when the main loop polled again are left out, their time includes the loop.
+struct OLEDTimingStats
+{
+	uint16_t count;
+	uint16_t min; // microseconds from sending the byte until the busy flag was seen cleared
+	uint16_t max;
+	uint32_t sum; // sum and count are halved together when count would overflow, which keeps the mean
+	uint16_t timeouts;
+};
+
 class OLEDFourBit : public Print
 {
   public:
@@ -120,6 +168,9 @@ class OLEDFourBit : public Print
 	// copy a line from the shadow copy to a string buffer and correct the degree sign
 	void getLine(uint8_t lineNumber, char *buffer);
 
+	// incremented on each change of the shadow copy, so a reader can tell whether the content changed since it last looked
+	uint16_t getContentVersion(void) const { return _contentVersion; }
+
 	void readContent(void); // read the content from the display to the shadow copy buffer
 
 	void command(uint8_t);
@@ -127,6 +178,12 @@ class OLEDFourBit : public Print
 
 	void setBufferOnly(bool bufferOnly) {}
 
+	// send the next queued command or changed character when the display is ready for it
+	void processQueue(void);
+
+	// compare one line of the display with the shadow copy, initialize the display again when they differ
+	bool checkContent(void);
+
 	void printSpacesToRestOfLine();
 
 	void resetBacklightTimer(void)
@@ -137,13 +194,28 @@ class OLEDFourBit : public Print
 	{ /* not implemented for OLED, doesn't have a backlight. */
 	}
 
+#if BREWPI_LOOP_STATS
+	const OLEDTimingStats &timingStats(uint8_t timingClass) const { return _timing[timingClass]; }
+	void resetTimingStats(void) { memset(_timing, 0, sizeof(_timing)); }
+#endif
+
 	using Print::write;
 
   private:
+	void enqueue(uint8_t value, uint8_t flags);
+	void transmit(uint8_t value, uint8_t flags);
+	void flush(void);
+	void initInterface(void);
+	void reinitialize(void);
 	void send(uint8_t, uint8_t);
 	void write4bits(uint8_t);
 	void pulseEnable();
-	void waitBusy();
+	uint8_t waitBusy(uint16_t timeoutMicros);
+	bool busyDone(uint16_t spinMicros);
+	void waitReady(void);
+#if BREWPI_LOOP_STATS
+	void recordTiming(uint8_t timingClass, ticks_micros_t micros, bool timedOut);
+#endif
 
 	uint8_t _rs_pin;	 // LOW: command.  HIGH: character.
 	uint8_t _rw_pin;	 // LOW: write to oled.  HIGH: read from oled.
@@ -158,8 +230,20 @@ class OLEDFourBit : public Print
 	uint8_t _currline;
 	uint8_t _currpos;
 	uint8_t _numlines;
+	uint8_t _checkLine; // line that is read back by the next checkContent()
+
+	uint8_t _busyTiming; // OLEDTimingClass of the byte the display is busy with, OLED_NOT_BUSY when it is done
+	bool _busyFlagWorks; // false when the busy flag timed out repeatedly, fixed delays are used instead
+	uint8_t _busyTimeouts; // bytes in a row for which the busy flag timed out
+	ticks_micros_t _busySince;
+#if BREWPI_LOOP_STATS
+	OLEDTimingStats _timing[OLED_TIMING_CLASSES];
+#endif
+
+	LcdCommandQueue queue;
 
 	char content[4][21]; // always keep a copy of the display content in this variable
+	uint16_t _contentVersion;
 
 	bool _bufferOnly;
 };
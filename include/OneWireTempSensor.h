@@ -41,6 +41,8 @@ class OneWire;
 
 class OneWireTempSensor : public BasicTempSensor
 {
+	DEVICE_POOL_ALLOCATED
+
   public:
 	/**
 	 * Constructs a new onewire temp sensor.
@@ -64,6 +64,18 @@ class PiLink
 
 	static void receiveJson(void); // receive settings as JSON key:value pairs
 
+	static void sendDisplaySnapshot(void);
+
+#if BREWPI_RAM_STATS
+	static void sendRamStats(void);
+#endif
+#if BREWPI_LOOP_STATS
+	static void sendLoopStats(void);
+#endif
+#if BREWPI_VIRTUAL_LCD
+	static void sendVirtualLcdFrames(void);
+#endif
+
 	static void print(char *fmt, ...); // use when format string is stored in RAM
 	static void print(char c)		   // inline for arduino
 #ifdef ARDUINO
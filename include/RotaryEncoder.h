@@ -38,38 +38,63 @@ license and credits. */
 // Anti-clockwise step.
 #define DIR_CCW 0x20
 
+// Events in the queue that is filled by the encoder interrupts. A turn event holds the number of steps in the low bits,
+// which is more than 1 when the encoder is turned fast.
+#define ROTARY_EVENT_NONE 0x00
+#define ROTARY_EVENT_CW 0x40
+#define ROTARY_EVENT_CCW 0x80
+#define ROTARY_EVENT_PUSH 0xC0
+#define ROTARY_EVENT_LONG_PRESS 0xC1
+#define ROTARY_EVENT_TYPE_MASK 0xC0
+#define ROTARY_EVENT_STEPS_MASK 0x3F
+
+// Must be a power of 2. The queue is emptied on each main loop iteration, so it only holds a burst of fast turns.
+#define ROTARY_EVENT_QUEUE_SIZE 8
+
 class RotaryEncoder
 {
   public:
 	static void init(void);
 	static void setRange(int16_t start, int16_t min, int16_t max);
+
+	// called from the interrupts with the pin states, these add events to the queue
 	static void process(uint8_t currPinA, uint8_t currPinB);
+	static void processButton(bool pressed);
 
-	static bool changed(void); // returns one if the value changed since the last call of changed.
-	static int16_t read(void);
+	/*
+	 * Takes the next event from the queue, or returns ROTARY_EVENT_NONE when the queue is empty. Turn events are applied
+	 * to the value returned by read(). The interrupts only write the head and the main loop only writes the tail,
+	 * so no interrupts need to be disabled.
+	 */
+	static uint8_t nextEvent(void);
 
-	static int16_t readsteps(void)
+	static int16_t read(void)
 	{
 		return steps;
 	}
 
-	static bool pushed(void)
-	{
-		return pushFlag;
-	}
-
-	static void resetPushed(void)
+	static bool isTurn(uint8_t event)
 	{
-		pushFlag = false;
+		uint8_t type = event & ROTARY_EVENT_TYPE_MASK;
+		return type == ROTARY_EVENT_CW || type == ROTARY_EVENT_CCW;
 	}
 
-	static void setPushed(void);
-
   private:
+	static void queueEvent(uint8_t event);
+
 	static int16_t maximum;
 	static int16_t minimum;
-	static volatile int16_t steps;
-	static volatile bool pushFlag;
+	static int16_t steps;
+
+	static volatile uint8_t events[ROTARY_EVENT_QUEUE_SIZE];
+	static volatile uint8_t eventHead; // written by the interrupts
+	static volatile uint8_t eventTail; // written by the main loop
+
+	// only used in the interrupts
+	static uint8_t lastDir;
+	static uint16_t lastStepTime;	// milliseconds, low bits are enough to measure the speed
+	static uint16_t lastButtonTime; // milliseconds, of the last press or release that was not a bounce
+	static bool buttonDown;
 };
 
 extern RotaryEncoder rotaryEncoder;
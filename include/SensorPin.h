@@ -31,9 +31,13 @@ license and credits. */
 
 #include "Brewpi.h"
 #include "Pins.h"
+#include "Sensor.h"
+#include "DevicePool.h"
 
 class DigitalPinSensor : public SwitchSensor
 {
+	DEVICE_POOL_ALLOCATED
+
   private:
 	bool invert;
 	uint8_t pin;
@@ -0,0 +1,73 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include "TemperatureFormats.h"
+
+// Number of samples in the regression window. Must be a power of 2, and at most 32 to keep the sums within 32 bits.
+#define SLOPE_WINDOW 32
+
+/*
+ * SlopeEstimator calculates the slope of its input as the least squares fit of a line through the last SLOPE_WINDOW
+ * samples, which are assumed to be 1 second apart.
+ *
+ * The sum and the index-weighted sum of the samples in the window are kept up to date incrementally, so adding a sample is
+ * O(1) and reading the slope costs one 32 bit division. With x = 0..n-1 (oldest first):
+ *
+ *          n*sum(x*y) - sum(x)*sum(y)
+ * slope = ----------------------------    with sum(x) = n(n-1)/2 and n*sum(x^2) - sum(x)^2 = n^2(n^2-1)/12
+ *          n*sum(x^2) - sum(x)^2
+ *
+ * Unlike the slope filter, the estimate is available after a few samples, because it does not need a filter to settle.
+ * Samples are stored as 16 bit values relative to a reference, with 4 more fraction bits than a regular temperature.
+ * When the input drifts too far from the reference, the reference is moved and the window is adjusted.
+ */
+class SlopeEstimator
+{
+  public:
+	SlopeEstimator() { init(0); }
+	~SlopeEstimator() {}
+
+	void init(temperature_precise val); // clears the window, the next samples are relative to val
+	void add(temperature_precise val);
+
+	temperature readSlope(void); // returns the slope per hour, as a temperature difference
+
+  private:
+	bool recenter(int32_t delta); // moves the reference by delta samples, returns false if the window would overflow
+
+	temperature_precise reference;
+	int16_t samples[SLOPE_WINDOW]; // ring buffer of samples, relative to reference
+	int32_t sum;				   // sum of the samples in the window
+	int32_t weightedSum;		   // sum of the samples in the window, multiplied by their index (oldest is 0)
+	uint8_t count;				   // number of samples in the window
+	uint8_t next;				   // position in the ring buffer of the next sample, which is also the oldest sample
+};
@@ -34,6 +34,7 @@ license and credits. */
 #include <stdint.h>
 #include <Print.h>
 #include "Ticks.h"
+#include "LcdCommandQueue.h"
 
 // commands
 #define LCD_CLEARDISPLAY 0x01
@@ -80,6 +81,19 @@ license and credits. */
 #define LCD_SHIFT_QD 3			 // unused QD pin
 #define LCD_SHIFT_DATA_MASK 0xF0 // Data bits, QE = D4, QF = D5, QG = D6, QH = D7
 
+// We cannot read the busy pin, so wait 1 ms after each byte. Clear and return home take 1.52 ms.
+#define LCD_BYTE_DELAY 1
+#define LCD_CLEAR_DELAY 2
+
+// Calls of checkContent() between the lines it sends again. Called every second, this repairs a scrambled display within
+// 4 * 45 = 180 seconds, the period of the display reset it replaced, at a small fraction of the regular bus traffic.
+#define LCD_RESYNC_INTERVAL 45
+
+// Bytes queued by begin() and the clear() of LcdDisplay::init(): 5 nibbles and delays, 6 commands and 1 clear
+#define LCD_INIT_QUEUE_LENGTH 12
+static_assert(LCD_INIT_QUEUE_LENGTH + LCD_COMMAND_QUEUE_HEADROOM <= LCD_COMMAND_QUEUE_SIZE,
+			  "the LCD initialization sequence does not fit in the LCD command queue");
+
 // Backlight is switched with a P-channel MOSFET, so signal is inverted.
 #define BACKLIGHT_AUTO_OFF_PERIOD 600
 
@@ -129,6 +143,9 @@ class SpiLcd : public Print
 	// copy a line from the shadow copy to a string buffer and correct the degree sign
 	void getLine(uint8_t lineNumber, char *buffer);
 
+	// incremented on each change of the shadow copy, so a reader can tell whether the content changed since it last looked
+	uint16_t getContentVersion(void) const { return _contentVersion; }
+
 	void readContent(void); // read the content from the display to the shadow copy buffer
 
 	void command(uint8_t);
@@ -136,6 +153,12 @@ class SpiLcd : public Print
 
 	void setBufferOnly(bool bufferOnly) { _bufferOnly = bufferOnly; }
 
+	// send the next queued command or changed character when the display is ready for it
+	void processQueue(void);
+
+	// send one line of the shadow copy again every LCD_RESYNC_INTERVAL calls, the display cannot be read back to check it
+	bool checkContent(void);
+
 	void resetBacklightTimer(void);
 
 	void updateBacklight(void);
@@ -157,10 +180,11 @@ class SpiLcd : public Print
   private:
 	void spiOut(void);
 	void initSpi(void);
+	void enqueue(uint8_t value, uint8_t flags);
+	void transmit(uint8_t value, uint8_t flags);
 	void send(uint8_t, uint8_t);
 	void write4bits(uint8_t);
 	void pulseEnable();
-	void waitBusy();
 
 	// Define shift register byte, keep pin state in this byte and send it out for each write.
 	volatile uint8_t _spiByte;
@@ -173,7 +197,12 @@ class SpiLcd : public Print
 	uint8_t _numlines;
 
 	bool _bufferOnly;
+	uint8_t _resyncLine;	  // line that is sent again next
+	uint8_t _resyncCountdown; // calls of checkContent() until that line is sent
 	uint16_t _backlightTime;
 
+	LcdCommandQueue queue;
+
 	char content[4][21]; // always keep a copy of the display content in this variable
+	uint16_t _contentVersion;
 };
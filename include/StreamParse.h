@@ -0,0 +1,70 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Reads an unsigned decimal number that is terminated by '\n' or '\r' from stream, e.g. the argument of a command.
+ * The bytes of a command arrive one by one, so each byte is waited for, for at most retries * 100 us.
+ * Returns true when digits followed by a line ending were read. The digits and the line ending are consumed, any other
+ * byte is left in the stream. When the number is not terminated in time, false is returned and value is incomplete.
+ */
+template <class Stream, class Delay>
+bool readTerminatedNumber(Stream &stream, Delay &delay, uint16_t retries, uint16_t &value)
+{
+	bool hasDigits = false;
+	value = 0;
+	for (;;)
+	{
+		uint16_t waited = 0;
+		while (stream.available() == 0)
+		{
+			if (waited++ >= retries)
+			{
+				return false;
+			}
+			delay.microseconds(100);
+		}
+		int character = stream.peek();
+		if (character == '\n' || character == '\r')
+		{
+			stream.read();
+			return hasDigits;
+		}
+		if (character < '0' || character > '9')
+		{
+			return false;
+		}
+		stream.read();
+		value = value * 10 + (character - '0');
+		hasDigits = true;
+	}
+}
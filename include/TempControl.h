@@ -167,6 +167,8 @@ class TempControl
 	TEMP_CONTROL_METHOD void loadSettings(eptr_t offset);
 	TEMP_CONTROL_METHOD void storeSettings(eptr_t offset);
 	TEMP_CONTROL_METHOD void loadDefaultSettings(void);
+	// call when the settings were written to EEPROM without storeSettings()
+	TEMP_CONTROL_METHOD void settingsStored(void) { storedBeerSetting = cs.beerSetting; }
 
 	TEMP_CONTROL_METHOD void loadConstants(eptr_t offset);
 	TEMP_CONTROL_METHOD void storeConstants(eptr_t offset);
@@ -0,0 +1,53 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include "TempControl.h"
+
+#if BREWPI_WARM_RESTART
+
+/*
+ * TempControlState keeps a snapshot of the controller in RAM that is not cleared at startup (.noinit), so that the
+ * controller can resume where it left off after a reset. On an Arduino Uno, every serial connection resets the board.
+ * Without the snapshot, the filters restart cold and the compressor/heater lockout timers start from zero.
+ *
+ * The snapshot is protected by a magic word and a CRC, so it is ignored after a power cycle, when RAM holds random data.
+ */
+class TempControlState
+{
+  public:
+	// stores the current state of tempControl. Called after each control update.
+	static void save(void);
+	// restores tempControl from the snapshot if it is valid. Called from setup(), after the settings are loaded.
+	static bool restore(void);
+};
+
+#endif
@@ -32,10 +32,19 @@ license and credits. */
 #include "Brewpi.h"
 #include "FilterCascaded.h"
 #include "TempSensorBasic.h"
+#include "DevicePool.h"
 #include <stdlib.h>
 
+#if TEMP_SENSOR_SLOPE_REGRESSION
+#include "SlopeEstimator.h"
+#endif
+
 #define TEMP_SENSOR_DISCONNECTED INVALID_TEMP
 
+// Maximum number of missed samples that are filled in when a sensor can be read again.
+// After more than 60 failed reads, init() restarts the filters from the current reading.
+#define TEMP_SENSOR_MAX_CATCH_UP 60
+
 #ifndef TEMP_SENSOR_CASCADED_FILTER
 #define TEMP_SENSOR_CASCADED_FILTER 1
 #endif
@@ -52,12 +61,29 @@ enum TempSensorType
 	TEMP_SENSOR_TYPE_BEER
 };
 
+#if BREWPI_WARM_RESTART
+// the filter outputs of a TempSensor, which are enough to resume filtering without a warm-up period
+struct TempSensorState
+{
+	temperature fast;
+	temperature slow;
+	temperature slope;
+};
+#endif
+
 class TempSensor
 {
+	DEVICE_POOL_ALLOCATED
+
   public:
 	TempSensor(TempSensorType sensorType, BasicTempSensor *sensor = NULL)
 	{
 		updateCounter = 255; // first update for slope filter after (255-4s)
+#if TEMP_SENSOR_SLOPE_REGRESSION
+		slopeRegression = (sensorType == TEMP_SENSOR_TYPE_BEER); // the beer slope is used for the PID derivative
+#else
+		(void)sensorType; // only selects the slope estimator
+#endif
 		setSensor(sensor);
 	}
 
@@ -96,6 +122,17 @@ class TempSensor
 
 	void setSlopeFilterCoefficients(uint8_t b);
 
+#if TEMP_SENSOR_SLOPE_REGRESSION
+	// select a least squares fit over the slow filter output for the slope instead of the slope filter
+	void setSlopeRegression(bool enabled);
+#endif
+
+#if BREWPI_WARM_RESTART
+	void saveState(TempSensorState &state);
+	// restores the filters from state, if the sensor is connected and its reading is close to the saved state
+	bool restoreState(const TempSensorState &state);
+#endif
+
 	BasicTempSensor &sensor();
 
   private:
@@ -105,9 +142,14 @@ class TempSensor
 	TempSensorFilter slopeFilter;
 	unsigned char updateCounter;
 	temperature_precise prevOutputForSlope;
+#if TEMP_SENSOR_SLOPE_REGRESSION
+	SlopeEstimator slopeEstimator;
+	bool slopeRegression;
+#endif
 
 	// An indication of how stale the data is in the filters. Each time a read fails, this value is incremented.
 	// It's used to reset the filters after a large enough disconnect delay, and on the first init.
+	// It is cleared by the next successful read, which fills in the missed samples.
 	uint8_t failedReadCount;
 
 	friend class ChamberManager;
@@ -30,6 +30,7 @@ license and credits. */
 #pragma once
 
 #include "Brewpi.h"
+#include "FixedPoint.h"
 #include <stdint.h>
 
 #ifndef INT16_MAX
@@ -79,26 +80,48 @@ typedef fixed7_9 temperature;
 typedef fixed23_9 long_temperature;
 typedef fixed7_25 temperature_precise;
 
+// Typed versions of the formats above, see FixedPoint.h. They have the same size and raw value as the plain integer types.
+// Regular temperatures reserve the lowest two values for INVALID_TEMP and DISABLED_TEMP.
+typedef Fixed<7, 9, 2> FixedTemperature;
+typedef Fixed<23, 9> FixedLongTemperature;
+typedef Fixed<7, 25> FixedTemperaturePrecise;
+
 #define TEMP_FIXED_POINT_BITS (9)
 #define TEMP_FIXED_POINT_SCALE (1 << TEMP_FIXED_POINT_BITS)
 #define TEMP_FIXED_POINT_MASK (TEMP_FIXED_POINT_SCALE - 1)
 #define TEMP_PRECISE_EXTRA_FRACTION_BITS 16
 
-#define tempToInt(val) (((val)-C_OFFSET + TEMP_FIXED_POINT_BITS / 2) >> TEMP_FIXED_POINT_BITS)
-#define longTempToInt(val) tempToInt(val)
-#define tempDiffToInt(val) (((val) + TEMP_FIXED_POINT_BITS / 2) >> TEMP_FIXED_POINT_BITS)
-#define longTempDiffToInt(val) tempDiffToInt(val)
+// Conversions from integers and constants, and between the regular and the precise format. They are implemented with
+// the typed formats, so they are checked for overflow in host builds and evaluated at compile time for constants.
+constexpr temperature intToTempDiff(int16_t val)
+{
+    return FixedTemperature::fromInt(val).raw();
+}
+
+constexpr temperature intToTemp(int16_t val)
+{
+    return (FixedTemperature::fromInt(val) + FixedTemperature::fromRaw(C_OFFSET)).raw();
+}
+
+constexpr temperature doubleToTempDiff(double temp)
+{
+    return FixedTemperature::fromDouble(temp).raw();
+}
+
+constexpr temperature doubleToTemp(double temp)
+{
+    return FixedTemperature::fromDouble(temp + double(C_OFFSET) / TEMP_FIXED_POINT_SCALE).raw();
+}
 
-#define intToTempDiff(val) (temperature(val) << TEMP_FIXED_POINT_BITS)
-#define intToTemp(val) (intToTempDiff(val) + C_OFFSET)
+constexpr temperature tempPreciseToRegular(temperature_precise val)
+{
+    return FixedTemperaturePrecise::fromRaw(val).convert<FixedTemperature>().raw();
+}
 
-// To explain the monstrosity below: for rounding, add -0.5 when negative, 0.5 when positive
-// This can be evaluated at compile time
-#define doubleToTemp(temp) (((temp)*TEMP_FIXED_POINT_SCALE + C_OFFSET + 0.5) >= MAX_TEMP ? MAX_TEMP : ((temp)*TEMP_FIXED_POINT_SCALE + C_OFFSET - 0.5) <= MIN_TEMP ? MIN_TEMP : (((temp)*TEMP_FIXED_POINT_SCALE + C_OFFSET) < 0) ? temperature((temp)*TEMP_FIXED_POINT_SCALE + C_OFFSET - 0.5) : temperature((temp)*TEMP_FIXED_POINT_SCALE + C_OFFSET + 0.5))
-#define doubleToTempDiff(temp) (((temp)*TEMP_FIXED_POINT_SCALE + 0.5) >= MAX_TEMP ? MAX_TEMP : ((temp)*TEMP_FIXED_POINT_SCALE - 0.5) <= MIN_TEMP ? MIN_TEMP : (((temp)*TEMP_FIXED_POINT_SCALE) < 0) ? temperature((temp)*TEMP_FIXED_POINT_SCALE - 0.5) : temperature((temp)*TEMP_FIXED_POINT_SCALE + 0.5))
-#define intToLongTemp(val) ((long_temperature(val) << TEMP_FIXED_POINT_BITS) + C_OFFSET)
-#define tempPreciseToRegular(val) ((val) >> TEMP_PRECISE_EXTRA_FRACTION_BITS)
-#define tempRegularToPrecise(val) (temperature_precise(val) << TEMP_PRECISE_EXTRA_FRACTION_BITS)
+constexpr temperature_precise tempRegularToPrecise(temperature val)
+{
+    return FixedTemperature::fromRaw(val).convert<FixedTemperaturePrecise>().raw();
+}
 
 char *tempToString(char *s, long_temperature rawValue, uint8_t numDecimals, uint8_t maxLength);
 char *tempDiffToString(char *s, long_temperature rawValue, uint8_t numDecimals, uint8_t maxLength);
@@ -115,6 +138,8 @@ bool stringToBool(bool *result, const char *numberString);
 bool stringToUint16(uint16_t *result, const char *numberString);
 
 int fixedToTenths(long_temperature temperature);
+// the value shown by tempToString() with 1 decimal as a number, to tell whether the text changes without formatting it
+int16_t tempToShownTenths(long_temperature temperature);
 temperature tenthsToFixed(int temperature);
 
 temperature constrainTemp(long_temperature val, temperature lower, temperature upper);
@@ -32,6 +32,7 @@ license and credits. */
 #include "Brewpi.h"
 #include "Platform.h"
 #include "TicksImpl.h"
+#include "FastDivide.h"
 #include <stdint.h>
 
 /**
@@ -73,7 +74,7 @@ class ExternalTicks
 
 	ticks_millis_t millis() { return _ticks; }
 	ticks_micros_t micros() { return _ticks * 1000; }
-	ticks_seconds_t seconds() { return millis() / 1000; }
+	ticks_seconds_t seconds() { return divideBy1000(millis()); }
 	ticks_seconds_t timeSince(ticks_seconds_t timeStamp);
 
 	void setMillis(ticks_millis_t now) { _ticks = now; }
@@ -0,0 +1,105 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#pragma once
+
+#include "Brewpi.h"
+#include "NullLcdDriver.h"
+#include "Ticks.h"
+#include <stdio.h>
+
+#if BREWPI_VIRTUAL_LCD
+
+#ifndef VIRTUAL_LCD_FRAMES
+#define VIRTUAL_LCD_FRAMES 16 // number of frames kept in the frame log
+#endif
+
+// A frame is everything drawn between two calls of processQueue(), which is called on every main loop iteration
+struct VirtualLcdFrame
+{
+	ticks_millis_t time; // when the frame was completed
+	uint16_t chars;		 // characters written
+	uint16_t changed;	// characters that differed from what was on the display
+	uint16_t commands;   // clear, home and cursor positioning
+	char content[4][21]; // the display after the frame
+};
+
+struct VirtualLcdStats
+{
+	uint32_t frames;
+	uint32_t chars;
+	uint32_t changed;
+	uint32_t commands;
+};
+
+/*
+ * VirtualLcd is a display driver without hardware for native builds. It keeps the text like NullLcdDriver and records
+ * each frame with a timestamp in a log of the last VIRTUAL_LCD_FRAMES frames. Frames can also be written to a file as
+ * they are completed. The counters make the render cost of the display code measurable per tick, and the frames can be
+ * compared with golden frames in tests of printState() or printMode().
+ */
+class VirtualLcd : public NullLcdDriver
+{
+  public:
+	VirtualLcd(){};
+	~VirtualLcd(){};
+
+	void init();
+	void begin(uint8_t cols, uint8_t rows);
+	void clear();
+	void home();
+	void setCursor(uint8_t col, uint8_t row);
+
+	virtual size_t write(uint8_t value);
+	using Print::write;
+
+	// completes the current frame, if anything was drawn
+	void processQueue(void);
+	bool checkContent(void) { return false; }
+
+	// Write each completed frame to this file as text, NULL to stop
+	void setFrameFile(FILE *file) { frameFile = file; }
+
+	uint8_t frameCount(void) const { return numFrames; }
+	const VirtualLcdFrame &frame(uint8_t index) const; // index 0 is the oldest frame in the log
+	const VirtualLcdStats &stats(void) const { return totals; }
+	void resetStats(void);
+
+	static void printFrame(FILE *file, const VirtualLcdFrame &frame);
+
+  private:
+	VirtualLcdFrame frames[VIRTUAL_LCD_FRAMES];
+	uint8_t nextFrame;
+	uint8_t numFrames;
+	VirtualLcdFrame current; // counters of the frame that is being drawn
+	VirtualLcdStats totals;
+	FILE *frameFile;
+};
+
+#endif
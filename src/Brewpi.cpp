@@ -31,6 +31,7 @@ license and credits. */
 #include "Ticks.h"
 #include "Display.h"
 #include "TempControl.h"
+#include "TempControlState.h"
 #include "PiLink.h"
 #include "TempSensor.h"
 #include "TempSensorMock.h"
@@ -39,7 +40,7 @@ license and credits. */
 #include "Sensor.h"
 #include "SettingsManager.h"
 #include "UI.h"
-#include "RotaryEncoder.h"
+#include "LoopStats.h"
 
 #if BREWPI_SIMULATE
 #include "Simulator.h"
@@ -67,6 +68,9 @@ void setup()
     logDebug("started");
     tempControl.init();
     settingsManager.loadSettings();
+#if BREWPI_WARM_RESTART
+    TempControlState::restore(); // resume control after a reset, e.g. by a serial connection
+#endif
 
     uint32_t start = millis();
     uint32_t delay = ui.showStartupPage();
@@ -90,41 +94,35 @@ void setup()
 void brewpiLoop(void)
 {
     static unsigned long lastUpdate = -1000; // init at -1000 to update immediately
-    static unsigned long lastLcdUpdate = 0;  // Counter for LCD reset
     uint8_t oldState;
     ui.ticks();
 
-    if (ticks.millis() - lastLcdUpdate >= (180000))
-    { //reset lcd every 180 seconds as a workaround for screen scramble from @Thorrak
-        lastLcdUpdate = ticks.millis();
-
-        display.init();
-        display.printStationaryText();
-        display.printState();
-
-        rotaryEncoder.init();
-    }
-
     if (!ui.inStartup() && (ticks.millis() - lastUpdate >= (1000)))
     { //update settings every second
         lastUpdate = ticks.millis();
+#if BREWPI_LOOP_STATS
+        LoopStats::controlTick();
+#endif
 
-        tempControl.updateTemperatures();
-        tempControl.detectPeaks();
-        tempControl.updatePID();
+        LOOP_TIMED(LOOP_PHASE_TEMPERATURES, tempControl.updateTemperatures());
+        LOOP_TIMED(LOOP_PHASE_PEAKS, tempControl.detectPeaks());
+        LOOP_TIMED(LOOP_PHASE_PID, tempControl.updatePID());
         oldState = tempControl.getState();
-        tempControl.updateState();
+        LOOP_TIMED(LOOP_PHASE_STATE, tempControl.updateState());
         if (oldState != tempControl.getState())
         {
             piLink.printTemperatures(); // add a data point at every state transition
         }
-        tempControl.updateOutputs();
+        LOOP_TIMED(LOOP_PHASE_OUTPUTS, tempControl.updateOutputs());
+#if BREWPI_WARM_RESTART
+        TempControlState::save();
+#endif
 
-        ui.update();
+        LOOP_TIMED(LOOP_PHASE_UI, ui.update());
     }
 
     //listen for incoming serial connections while waiting to update
-    piLink.receive();
+    LOOP_TIMED(LOOP_PHASE_RECEIVE, piLink.receive());
 }
 
 void loop()
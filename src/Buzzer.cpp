@@ -33,7 +33,6 @@ license and credits. */
 #include "Buzzer.h"
 
 #if BREWPI_BUZZER
-#include <util/delay.h>
 #include "FastDigitalPin.h"
 
 #if (alarmPin != 3)
@@ -93,18 +92,39 @@ void Buzzer::setActive(bool active)
 	}
 }
 
-void Buzzer::beep(uint8_t numBeeps, uint16_t duration)
+const uint8_t BUZZER_STARTUP[] PROGMEM = {50, 50, 50, 0};
+const uint8_t BUZZER_ALARM[] PROGMEM = {25, 25, 25, 25, 25, 125, 0};
+
+void Buzzer::play(const uint8_t *newPattern)
+{
+	pattern = newPattern;
+	stepStart = ticks.millis();
+	stepDuration = 0; // the first step starts on the next update()
+	setActive(false);
+}
+
+void Buzzer::stop(void)
 {
-	for (uint8_t beepCount = 0; beepCount < numBeeps; beepCount++)
+	pattern = NULL;
+	setActive(false);
+}
+
+void Buzzer::update(void)
+{
+	if (pattern == NULL || ticks.millis() - stepStart < stepDuration)
 	{
-		BEEP_ON();
-		wait.millis(duration);
-		BEEP_OFF();
-		if (beepCount < numBeeps - 1)
-		{
-			wait.millis(duration); // not the last beep
-		}
+		return;
+	}
+	uint8_t duration = pgm_read_byte(pattern);
+	if (duration == 0)
+	{
+		stop();
+		return;
 	}
+	pattern++;
+	setActive(!isActive()); // steps alternate between on and off
+	stepStart = ticks.millis();
+	stepDuration = duration * BUZZER_STEP_MILLIS;
 }
 
 Buzzer buzzer;
@@ -281,9 +281,10 @@ void DeviceManager::installDevice(DeviceConfig &config)
 		DEBUG_ONLY(logInfoInt(INFO_INSTALL_TEMP_SENSOR, config.deviceFunction));
 		// sensor may be wrapped in a TempSensor class, or may stand alone.
 		s = (BasicTempSensor *)createDevice(config, dt);
-		if (*ppv == NULL)
+		if (s == NULL)
 		{
 			logErrorInt(ERROR_OUT_OF_MEMORY_FOR_DEVICE, config.deviceFunction);
+			break;
 		}
 		if (isBasicSensor(config.deviceFunction))
 		{
@@ -304,10 +305,14 @@ void DeviceManager::installDevice(DeviceConfig &config)
 	case DEVICETYPE_SWITCH_SENSOR:
 		DEBUG_ONLY(logInfoInt(INFO_INSTALL_DEVICE, config.deviceFunction));
 		*ppv = createDevice(config, dt);
-#if (BREWPI_DEBUG > 0)
 		if (*ppv == NULL)
+		{
+#if (BREWPI_DEBUG > 0)
 			logErrorInt(ERROR_OUT_OF_MEMORY_FOR_DEVICE, config.deviceFunction);
 #endif
+			// the pool is full, keep the no-op default device so tempControl never sees NULL
+			*ppv = (dt == DEVICETYPE_SWITCH_ACTUATOR) ? (void *)&defaultActuator : (void *)&defaultSensor;
+		}
 		break;
 	}
 }
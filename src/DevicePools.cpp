@@ -0,0 +1,84 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#include "Brewpi.h"
+#include "DevicePool.h"
+
+#if BREWPI_DEVICE_POOLS
+
+#include "TempSensor.h"
+#include "OneWireTempSensor.h"
+#include "DallasTemperature.h"
+#include "ActuatorPin.h"
+#include "SensorPin.h"
+
+/*
+ * Only devices with a function in the chamber or beer are installed (see deviceTarget() in DeviceManager.cpp), at most
+ * one per function: 3 temp sensors (room, fridge, beer), 4 actuators (heat, cool, light, fan) and 1 switch sensor (door).
+ * An existing device is always uninstalled before its replacement is installed.
+ */
+#define TEMP_SENSOR_POOL_SIZE 2
+#define ONEWIRE_TEMP_SENSOR_POOL_SIZE 3
+#define DALLAS_TEMPERATURE_POOL_SIZE (ONEWIRE_TEMP_SENSOR_POOL_SIZE + 1) // +1 for the sensor read while listing hardware
+#define PIN_ACTUATOR_POOL_SIZE 4
+#define PIN_SENSOR_POOL_SIZE 1
+
+#define DEFINE_DEVICE_POOL(type, pool, capacity)                                  \
+	static DevicePool<sizeof(type), capacity> pool;                               \
+	void *type::operator new(size_t size) noexcept { return pool.allocate(size); } \
+	void type::operator delete(void *p) { pool.release(p); }
+
+DEFINE_DEVICE_POOL(TempSensor, tempSensorPool, TEMP_SENSOR_POOL_SIZE)
+DEFINE_DEVICE_POOL(OneWireTempSensor, oneWireTempSensorPool, ONEWIRE_TEMP_SENSOR_POOL_SIZE)
+#if !REQUIRESNEW
+DEFINE_DEVICE_POOL(DallasTemperature, dallasTemperaturePool, DALLAS_TEMPERATURE_POOL_SIZE)
+#endif
+DEFINE_DEVICE_POOL(DigitalPinActuator, pinActuatorPool, PIN_ACTUATOR_POOL_SIZE)
+DEFINE_DEVICE_POOL(DigitalPinSensor, pinSensorPool, PIN_SENSOR_POOL_SIZE)
+
+const DevicePoolStats &devicePoolStats(uint8_t pool)
+{
+	switch (pool)
+	{
+	case DEVICE_POOL_TEMP_SENSOR:
+		return tempSensorPool.getStats();
+	case DEVICE_POOL_ONEWIRE_TEMP_SENSOR:
+		return oneWireTempSensorPool.getStats();
+#if !REQUIRESNEW
+	case DEVICE_POOL_DALLAS_TEMPERATURE:
+		return dallasTemperaturePool.getStats();
+#endif
+	case DEVICE_POOL_PIN_ACTUATOR:
+		return pinActuatorPool.getStats();
+	default:
+		return pinSensorPool.getStats();
+	}
+}
+
+#endif
@@ -35,10 +35,23 @@ license and credits. */
 #include "TempControl.h"
 #include "Pins.h"
 #include "fixstl.h"
+#include "FastDivide.h"
+#include "Logger.h"
 
 uint8_t LcdDisplay::stateOnDisplay;
 uint8_t LcdDisplay::flags;
 LcdDriver LcdDisplay::lcd;
+uint8_t LcdDisplay::invalidFields;
+int16_t LcdDisplay::shownBeerTemp;
+int16_t LcdDisplay::shownBeerSet;
+int16_t LcdDisplay::shownFridgeTemp;
+int16_t LcdDisplay::shownFridgeSet;
+int16_t LcdDisplay::shownMode;
+int16_t LcdDisplay::shownTime;
+#if BREWPI_LOOP_STATS
+uint16_t LcdDisplay::fieldsDrawn;
+uint16_t LcdDisplay::fieldsSkipped;
+#endif
 
 // Constant strings used multiple times
 static const char STR_Beer_[] PROGMEM = "Beer ";
@@ -55,11 +68,22 @@ void LcdDisplay::init(void)
 {
 	stateOnDisplay = 0xFF; // set to unknown state to force update
 	flags = LCD_FLAG_ALTERNATE_ROOM;
+	invalidFields = LCD_FIELD_ALL;
 	lcd.init(); // initialize LCD
 	lcd.begin(20, 4);
 	lcd.clear();
 }
 
+// The lcd used to be initialized again every 180 seconds as a workaround for screen scramble. Now the driver checks one
+// line per call and is only initialized again when corruption is detected. The text is kept by the driver.
+void LcdDisplay::checkContent(void)
+{
+	if (lcd.checkContent())
+	{
+		logDebug("lcd content corrupted, initializing lcd again");
+	}
+}
+
 #ifndef UINT16_MAX
 #define UINT16_MAX 65535
 #endif
@@ -91,20 +115,48 @@ void LcdDisplay::setDisplayFlags(uint8_t newFlags)
 	printAllTemperatures();
 }
 
+bool LcdDisplay::fieldChanged(uint8_t field, int16_t &shown, int16_t value)
+{
+	if (!(invalidFields & field) && shown == value)
+	{
+#if BREWPI_LOOP_STATS
+		fieldsSkipped++;
+#endif
+		return false;
+	}
+	invalidFields &= ~field;
+	shown = value;
+#if BREWPI_LOOP_STATS
+	fieldsDrawn++;
+#endif
+	return true;
+}
+
+void LcdDisplay::printTemperatureField(uint8_t field, int16_t &shown, uint8_t x, uint8_t y, temperature temp)
+{
+	// compare the value as printTemperature() shows it, instead of formatting the string to find out
+	int16_t shownTenths = isDisabledOrInvalid(temp) ? INT16_MIN : tempToShownTenths(temp);
+	if (fieldChanged(field, shown, shownTenths))
+	{
+		printTemperatureAt(x, y, temp);
+	}
+}
+
 void LcdDisplay::printBeerTemp(void)
 {
-	printTemperatureAt(6, 1, tempControl.getBeerTemp());
+	printTemperatureField(LCD_FIELD_BEER_TEMP, shownBeerTemp, 6, 1, tempControl.getBeerTemp());
 }
 
 void LcdDisplay::printBeerSet(void)
 {
 	temperature beerSet = tempControl.getBeerSetting();
-	printTemperatureAt(12, 1, beerSet);
+	printTemperatureField(LCD_FIELD_BEER_SET, shownBeerSet, 12, 1, beerSet);
 }
 
 void LcdDisplay::printFridgeTemp(void)
 {
-	printTemperatureAt(6, 2, flags & LCD_FLAG_DISPLAY_ROOM ? tempControl.ambientSensor->read() : tempControl.getFridgeTemp());
+	printTemperatureField(LCD_FIELD_FRIDGE_TEMP, shownFridgeTemp, 6, 2,
+						  flags & LCD_FLAG_DISPLAY_ROOM ? tempControl.ambientSensor->read() : tempControl.getFridgeTemp());
 }
 
 void LcdDisplay::printFridgeSet(void)
@@ -112,7 +164,7 @@ void LcdDisplay::printFridgeSet(void)
 	temperature fridgeSet = tempControl.getFridgeSetting();
 	if (flags & LCD_FLAG_DISPLAY_ROOM) // beer setting is not active
 		fridgeSet = DISABLED_TEMP;
-	printTemperatureAt(12, 2, fridgeSet);
+	printTemperatureField(LCD_FIELD_FRIDGE_SET, shownFridgeSet, 12, 2, fridgeSet);
 }
 
 void LcdDisplay::printTemperatureAt(uint8_t x, uint8_t y, temperature temp)
@@ -139,8 +191,11 @@ void LcdDisplay::printTemperature(temperature temp)
 }
 
 //print the stationary text on the lcd.
+// Redraws the labels and units. The temperatures are drawn again as well, because the label of the fridge temperature or
+// the temperature format may have changed.
 void LcdDisplay::printStationaryText(void)
 {
+	invalidFields |= LCD_FIELD_TEMPERATURES;
 	printAt_P(0, 0, PSTR("Mode"));
 	printAt_P(0, 1, STR_Beer_);
 	printAt_P(0, 2, (flags & LCD_FLAG_DISPLAY_ROOM) ? PSTR("Room  ") : STR_Fridge_);
@@ -171,6 +226,10 @@ void LcdDisplay::printAt(uint8_t x, uint8_t y, char *text)
 // print mode on the right location on the first line, after "Mode   "
 void LcdDisplay::printMode(void)
 {
+	if (!fieldChanged(LCD_FIELD_MODE, shownMode, tempControl.getMode()))
+	{
+		return;
+	}
 	lcd.setCursor(7, 0);
 	// Factoring prints out of switch has negative effect on code size in this function
 	switch (tempControl.getMode())
@@ -257,6 +316,7 @@ void LcdDisplay::printState(void)
 		printAt_P(0, 3, part1);
 		lcd.print_P(part2);
 		lcd.printSpacesToRestOfLine();
+		invalidFields |= LCD_FIELD_TIME;
 	}
 	uint16_t sinceIdleTime = tempControl.timeSinceIdle();
 	if (state == IDLE)
@@ -280,13 +340,13 @@ void LcdDisplay::printState(void)
 	{
 		time = tempControl.getWaitTime();
 	}
-	if (time != UINT16_MAX)
+	if (time != UINT16_MAX && fieldChanged(LCD_FIELD_TIME, shownTime, time))
 	{
 		char timeString[10];
 #if DISPLAY_TIME_HMS // 96 bytes more space required.
-		unsigned int minutes = time / 60;
-		unsigned int hours = minutes / 60;
-		int stringLength = sprintf_P(timeString, PSTR("%dh%02dm%02d"), hours, minutes % 60, time % 60);
+		unsigned int minutes = divideBy60(time);
+		unsigned int hours = divideBy60(minutes);
+		int stringLength = sprintf_P(timeString, PSTR("%dh%02dm%02d"), hours, minutes - hours * 60, time - minutes * 60);
 		char *printString = timeString;
 		if (!hours)
 		{
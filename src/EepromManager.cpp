@@ -34,10 +34,16 @@ license and credits. */
 #include "TempControl.h"
 #include "EepromFormat.h"
 #include "PiLink.h"
+#include "Ticks.h"
 
 EepromManager eepromManager;
 EepromAccess eepromAccess;
 
+#if BREWPI_LOG_DEBUG
+// bytes changed by zapEeprom() and initializeEeprom(), only counted for the debug log
+static uint16_t bytesWritten;
+#endif
+
 #define pointerOffset(x) offsetof(EepromFormat, x)
 
 EepromManager::EepromManager()
@@ -53,15 +59,23 @@ bool EepromManager::hasSettings()
 
 void EepromManager::zapEeprom()
 {
-	for (uint16_t offset = 0; offset < EepromFormat::MAX_EEPROM_SIZE; offset++)
-		eepromAccess.writeByte(offset, 0xFF);
+#if BREWPI_LOG_DEBUG
+	ticks_millis_t start = ticks.millis();
+	bytesWritten = 0;
+#endif
+	fillBlock(0, 0xFF, EepromFormat::MAX_EEPROM_SIZE);
+	logDebug("EepromManager - zapped, %u bytes written in %lu ms", bytesWritten, ticks.millis() - start);
 }
 
 void EepromManager::initializeEeprom()
 {
-	// clear all eeprom
-	for (uint16_t offset = 0; offset < EepromFormat::MAX_EEPROM_SIZE; offset++)
-		eepromAccess.writeByte(offset, 0);
+#if BREWPI_LOG_DEBUG
+	ticks_millis_t start = ticks.millis();
+	bytesWritten = 0;
+#endif
+
+	// invalidate the current settings first, so an interrupted initialization is not mistaken for valid settings
+	updateByte(pointerOffset(version), 0);
 
 	deviceManager.setupUnconfiguredDevices();
 
@@ -69,28 +83,65 @@ void EepromManager::initializeEeprom()
 	tempControl.loadDefaultConstants();
 	tempControl.loadDefaultSettings();
 
-	// write the default constants
+	// Stream the default image region by region, in address order. Each byte is compared with the eeprom
+	// and only written when it differs, so a factory reset on an already initialized eeprom costs almost no writes.
+	fillBlock(pointerOffset(numChambers), 0, pointerOffset(chambers) - pointerOffset(numChambers));
 	for (uint8_t c = 0; c < EepromFormat::MAX_CHAMBERS; c++)
 	{
 		eptr_t pv = pointerOffset(chambers) + (c * sizeof(ChamberBlock));
-		tempControl.storeConstants(pv + offsetof(ChamberBlock, chamberSettings.cc));
-		pv += offsetof(ChamberBlock, beer) + offsetof(BeerBlock, cs);
+		updateBlock(pv + offsetof(ChamberBlock, chamberSettings.cc), &tempControl.cc, sizeof(ControlConstants));
+		fillBlock(pv + offsetof(ChamberBlock, chamberSettings.reserved), 0, sizeof(ChamberSettings::reserved));
+		pv += offsetof(ChamberBlock, beer);
 		for (uint8_t b = 0; b < ChamberBlock::MAX_BEERS; b++)
 		{
-			//			logDeveloper(PSTR("EepromManager - saving settings for beer %d at %d"), b, (uint16_t)pv);
-			tempControl.storeSettings(pv);
+			updateBlock(pv + offsetof(BeerBlock, cs), &tempControl.cs, sizeof(ControlSettings));
+			fillBlock(pv + offsetof(BeerBlock, reserved), 0, sizeof(BeerBlock::reserved));
 			pv += sizeof(BeerBlock); // advance to next beer
 		}
 	}
+	// no devices are installed, clear the device table and any unused space after it
+	fillBlock(pointerOffset(devices), 0, EepromFormat::MAX_EEPROM_SIZE - pointerOffset(devices));
 
 	// set the version flag - so that storeDevice will work
-	eepromAccess.writeByte(0, EEPROM_FORMAT_VERSION);
+	updateByte(pointerOffset(version), EEPROM_FORMAT_VERSION);
+
+	logDebug("EepromManager - initialized, %u bytes written in %lu ms", bytesWritten, ticks.millis() - start);
+	// the settings were written without storeSettings(), which keeps track of the beer setting in eeprom
+	tempControl.settingsStored();
 
 	saveDefaultDevices();
 	// set state to startup
 	tempControl.init();
 }
 
+// writeByte() and writeBlock() already skip bytes that hold the value, only counting the writes needs a read here
+void EepromManager::updateByte(eptr_t offset, uint8_t value)
+{
+#if BREWPI_LOG_DEBUG
+	if (eepromAccess.readByte(offset) == value)
+		return;
+	bytesWritten++;
+#endif
+	eepromAccess.writeByte(offset, value);
+}
+
+void EepromManager::updateBlock(eptr_t offset, const void *source, uint16_t size)
+{
+#if BREWPI_LOG_DEBUG
+	const uint8_t *p = (const uint8_t *)source;
+	while (size-- > 0)
+		updateByte(offset++, *p++);
+#else
+	eepromAccess.writeBlock(offset, source, size);
+#endif
+}
+
+void EepromManager::fillBlock(eptr_t offset, uint8_t value, uint16_t size)
+{
+	while (size-- > 0)
+		updateByte(offset++, value);
+}
+
 uint8_t EepromManager::saveDefaultDevices()
 {
 	return 0;
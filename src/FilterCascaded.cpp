@@ -35,18 +35,13 @@ license and credits. */
 
 CascadedFilter::CascadedFilter()
 {
-	for (uint8_t i = 0; i < NUM_SECTIONS; i++)
-	{
-		sections[i].setCoefficients(2); // default to a b value of 2
-	}
+	setCoefficients(2); // default to a b value of 2
 }
 
 void CascadedFilter::setCoefficients(uint8_t bValue)
 {
-	for (uint8_t i = 0; i < NUM_SECTIONS; i++)
-	{
-		sections[i].setCoefficients(bValue);
-	}
+	a = bValue * 2 + 4;
+	b = bValue;
 }
 
 temperature CascadedFilter::add(temperature val)
@@ -59,34 +54,96 @@ temperature CascadedFilter::add(temperature val)
 
 temperature_precise CascadedFilter::addDoublePrecision(temperature_precise val)
 {
-	temperature_precise input = val;
+	// shift the history of the input and of all section outputs
+	for (uint8_t i = 0; i <= NUM_SECTIONS; i++)
+	{
+		history[i][2] = history[i][1];
+		history[i][1] = history[i][0];
+	}
+	history[0][0] = val;
+
 	// input is input for next section, which is the output of the previous section
 	for (uint8_t i = 0; i < NUM_SECTIONS; i++)
 	{
-		input = sections[i].addDoublePrecision(input);
+		history[i + 1][0] = FixedFilter::calculateOutput(history[i], history[i + 1], a, b);
 	}
-	return input;
+	return history[NUM_SECTIONS][0];
+}
+
+void CascadedFilter::addN(temperature val, uint8_t count)
+{
+	addNDoublePrecision(tempRegularToPrecise(val), count);
+}
+
+void CascadedFilter::addNDoublePrecision(temperature_precise val, uint8_t count)
+{
+	if (count < FILTER_CLOSED_FORM_MIN_SAMPLES)
+	{
+		while (count--)
+		{
+			addDoublePrecision(val);
+		}
+		return;
+	}
+	addDoublePrecision(val);
+	addDoublePrecision(val); // the input history is now the held value, as the closed form requires
+	temperature_precise *outputs[NUM_SECTIONS];
+	for (uint8_t i = 0; i < NUM_SECTIONS; i++)
+	{
+		outputs[i] = history[i + 1];
+	}
+	FixedFilter::advanceHeldInput<NUM_SECTIONS>(outputs, b, val, count - 3);
+	addDoublePrecision(val); // the last sample is stepped, which also shifts the history into history[i][2]
 }
 
 temperature CascadedFilter::readInput(void)
 {
-	return sections[0].readInput(); // return input of first section
+	return tempPreciseToRegular(history[0][0]); // return input of first section
 }
 
 temperature_precise CascadedFilter::readOutputDoublePrecision(void)
 {
-	return sections[NUM_SECTIONS - 1].readOutputDoublePrecision(); // return output of last section
+	return history[NUM_SECTIONS][0]; // return output of last section
 }
 
 temperature_precise CascadedFilter::readPrevOutputDoublePrecision(void)
 {
-	return sections[NUM_SECTIONS - 1].readPrevOutputDoublePrecision(); // return previous output of last section
+	return history[NUM_SECTIONS][1]; // return previous output of last section
 }
 
 void CascadedFilter::init(temperature val)
 {
-	for (uint8_t i = 0; i < NUM_SECTIONS; i++)
+	temperature_precise valDoublePrecision = tempRegularToPrecise(val); // 16 extra bits are used in the filter for the fraction part
+	for (uint8_t i = 0; i <= NUM_SECTIONS; i++)
+	{
+		history[i][0] = valDoublePrecision;
+		history[i][1] = valDoublePrecision;
+		history[i][2] = valDoublePrecision;
+	}
+}
+
+temperature CascadedFilter::detectPosPeak(void)
+{
+	const temperature_precise *yv = history[NUM_SECTIONS];
+	if (yv[0] < yv[1] && yv[1] >= yv[2])
+	{
+		return tempPreciseToRegular(yv[1]);
+	}
+	else
+	{
+		return INVALID_TEMP;
+	}
+}
+
+temperature CascadedFilter::detectNegPeak(void)
+{
+	const temperature_precise *yv = history[NUM_SECTIONS];
+	if (yv[0] > yv[1] && yv[1] <= yv[2])
+	{
+		return tempPreciseToRegular(yv[1]);
+	}
+	else
 	{
-		sections[i].init(val);
+		return INVALID_TEMP;
 	}
 }
@@ -34,8 +34,8 @@ license and credits. */
 
 temperature FixedFilter::add(temperature val)
 {
-	temperature_precise returnVal = addDoublePrecision(tempRegularToPrecise(val));
-	return tempPreciseToRegular(returnVal);
+	FixedTemperaturePrecise returnVal = FixedTemperaturePrecise::fromRaw(addDoublePrecision(toPrecise(val)));
+	return returnVal.convert<FixedTemperature>().raw();
 }
 
 temperature_precise FixedFilter::addDoublePrecision(temperature_precise val)
@@ -47,19 +47,36 @@ temperature_precise FixedFilter::addDoublePrecision(temperature_precise val)
 	yv[2] = yv[1];
 	yv[1] = yv[0];
 
-	/* Implementation that prevents overflow as much as possible by order of operations: */
-	yv[0] = ((yv[1] - yv[2]) + yv[1])						  // expected value + 1*
-			- (yv[1] >> b) + (yv[2] >> b) +					  // expected value +0*
-			+(xv[0] >> a) + (xv[1] >> (a - 1)) + (xv[2] >> a) // expected value +(1>>(a-2))
-			- (yv[2] >> (a - 2));							  // expected value -(1>>(a-2))
+	yv[0] = calculateOutput(xv, yv, a, b);
 
 	return yv[0];
 }
 
+void FixedFilter::addN(temperature val, uint8_t count)
+{
+	addNDoublePrecision(toPrecise(val), count);
+}
+
+void FixedFilter::addNDoublePrecision(temperature_precise val, uint8_t count)
+{
+	if (count < FILTER_CLOSED_FORM_MIN_SAMPLES)
+	{
+		while (count--)
+		{
+			addDoublePrecision(val);
+		}
+		return;
+	}
+	addDoublePrecision(val);
+	addDoublePrecision(val); // the input history is now the held value, as the closed form requires
+	temperature_precise *const outputs[1] = {yv};
+	advanceHeldInput<1>(outputs, b, val, count - 3);
+	addDoublePrecision(val); // the last sample is stepped, which also shifts the history into yv[2]
+}
+
 void FixedFilter::init(temperature val)
 {
-	xv[0] = val;
-	xv[0] = tempRegularToPrecise(xv[0]); // 16 extra bits are used in the filter for the fraction part
+	xv[0] = toPrecise(val); // 16 extra bits are used in the filter for the fraction part
 
 	xv[1] = xv[0];
 	xv[2] = xv[0];
@@ -73,7 +90,7 @@ temperature FixedFilter::detectPosPeak(void)
 {
 	if (yv[0] < yv[1] && yv[1] >= yv[2])
 	{
-		return tempPreciseToRegular(yv[1]);
+		return toRegular(yv[1]);
 	}
 	else
 	{
@@ -85,7 +102,7 @@ temperature FixedFilter::detectNegPeak(void)
 {
 	if (yv[0] > yv[1] && yv[1] <= yv[2])
 	{
-		return tempPreciseToRegular(yv[1]);
+		return toRegular(yv[1]);
 	}
 	else
 	{
@@ -0,0 +1,102 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#include "Brewpi.h"
+#include "LoopStats.h"
+#include <string.h>
+
+#if BREWPI_LOOP_STATS
+
+// the interval between control ticks in brewpiLoop()
+#define CONTROL_TICK_INTERVAL_MICROS 1000000ul
+
+LoopPhaseStats LoopStats::stats[NUM_LOOP_PHASES];
+ticks_micros_t LoopStats::lastControlTick;
+
+static const char phaseNames[NUM_LOOP_PHASES][8] PROGMEM = {
+	"temps", "peaks", "pid", "state", "outputs", "ui", "receive", "late"};
+
+const char *LoopStats::name(uint8_t phase)
+{
+	return phaseNames[phase];
+}
+
+void LoopStats::record(uint8_t phase, ticks_micros_t duration)
+{
+	LoopPhaseStats &s = stats[phase];
+	if (s.count == 0 || duration < s.min)
+	{
+		s.min = duration;
+	}
+	if (duration > s.max)
+	{
+		s.max = duration;
+	}
+	if (s.count == UINT16_MAX || s.sum + duration < s.sum)
+	{
+		s.count >>= 1;
+		s.sum >>= 1;
+	}
+	s.sum += duration;
+	s.count++;
+
+	uint8_t bucket = 0;
+	for (ticks_micros_t v = duration >> 5; v && bucket < LOOP_STATS_BUCKETS - 1; v >>= 1)
+	{
+		bucket++;
+	}
+	if (s.buckets[bucket] == UINT8_MAX)
+	{
+		for (uint8_t i = 0; i < LOOP_STATS_BUCKETS; i++)
+		{
+			s.buckets[i] >>= 1;
+		}
+	}
+	s.buckets[bucket]++;
+}
+
+void LoopStats::controlTick(void)
+{
+	ticks_micros_t now = ticks.micros();
+	if (lastControlTick != 0)
+	{
+		ticks_micros_t interval = now - lastControlTick;
+		// the tick is started from the millis() count, so it can be a fraction of a millisecond early in micros()
+		record(LOOP_TICK_LATENESS, interval > CONTROL_TICK_INTERVAL_MICROS ? interval - CONTROL_TICK_INTERVAL_MICROS : 0);
+	}
+	lastControlTick = now | 1; // never 0, which marks the first tick
+}
+
+void LoopStats::reset(void)
+{
+	memset(stats, 0, sizeof(stats));
+	lastControlTick = 0;
+}
+
+#endif
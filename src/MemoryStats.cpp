@@ -0,0 +1,112 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#include "Brewpi.h"
+#include "MemoryStats.h"
+
+#if BREWPI_RAM_STATS
+
+#define STACK_PAINT 0xC5
+
+#if defined(ARDUINO)
+
+extern uint8_t _end;	// end of .bss and .noinit, start of the heap
+extern uint8_t __stack; // top of RAM
+extern char *__brkval;	// top of the heap, 0 when nothing has been allocated
+extern size_t __malloc_margin; // malloc keeps this many bytes free below the stack pointer
+
+// the heap free list of avr-libc malloc
+struct __freelist
+{
+	size_t sz;
+	struct __freelist *nx;
+};
+extern struct __freelist *__flp;
+
+// Runs from .init3: the stack pointer is set up, but .bss is not cleared and no constructors have run yet.
+// Naked, so it has no prologue or return and falls through to .init4. The loop is in assembly, because only basic asm
+// is safe in a naked function: the compiler could keep a C local on the stack that is being painted.
+// X walks from _end to the top of RAM, Z is one past the top. r1, which must stay zero, is not used.
+void paintStack(void) __attribute__((naked, used, section(".init3")));
+void paintStack(void)
+{
+	asm volatile(
+		"	ldi r26, lo8(_end)\n"
+		"	ldi r27, hi8(_end)\n"
+		"	ldi r30, lo8(__stack + 1)\n"
+		"	ldi r31, hi8(__stack + 1)\n"
+		"	ldi r24, " stringify(STACK_PAINT) "\n"
+		"1:	st X+, r24\n"
+		"	cp r26, r30\n"
+		"	cpc r27, r31\n"
+		"	brlo 1b\n");
+}
+
+void MemoryStats::read(RamStats &stats)
+{
+	uint8_t stackTop; // address of a local is close to the current stack pointer
+	uint8_t *heapEnd = __brkval ? (uint8_t *)__brkval : &_end;
+	uint16_t gap = &stackTop - heapEnd;
+
+	uint16_t freeList = 0;
+	uint16_t largest = gap > __malloc_margin ? gap - __malloc_margin : 0;
+	for (struct __freelist *block = __flp; block; block = block->nx)
+	{
+		freeList += block->sz;
+		if (block->sz > largest)
+		{
+			largest = block->sz;
+		}
+	}
+	stats.freeRam = gap + freeList;
+	stats.largestBlock = largest;
+
+	// the heap only grows during setup, so scanning from its current end finds the deepest stack use since startup
+	uint8_t *p = heapEnd;
+	while (p < &stackTop && *p == STACK_PAINT)
+	{
+		p++;
+	}
+	stats.stackWatermark = p - heapEnd;
+	stats.stackMax = &__stack - p + 1;
+}
+
+#else
+
+void MemoryStats::read(RamStats &stats)
+{
+	stats.freeRam = 0;
+	stats.largestBlock = 0;
+	stats.stackWatermark = 0;
+	stats.stackMax = 0;
+}
+
+#endif
+
+#endif
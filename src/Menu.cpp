@@ -45,202 +45,252 @@ license and credits. */
 Menu menu;
 
 #define MENU_TIMEOUT 10u
+#define MENU_BLINK_PERIOD 768u // milliseconds, the value is shown during the first half and hidden during the second
+
+menuPages Menu::page;
+bool Menu::blinkVisible;
+uint16_t Menu::lastChangeTime;
+ticks_millis_t Menu::blinkStartTime;
+uint8_t Menu::oldDisplayFlags;
+control_mode_t Menu::oldMode;
+control_mode_t Menu::pickedMode;
+temperature Menu::pickedTemp;
 
 void Menu::pickSettingToChange()
 {
 	// ensure beer temp is displayed
-	uint8_t oldFlags = display.getDisplayFlags();
-	display.setDisplayFlags(oldFlags & ~(LCD_FLAG_ALTERNATE_ROOM | LCD_FLAG_DISPLAY_ROOM));
-	pickSettingToChangeLoop();
-	display.setDisplayFlags(oldFlags);
+	oldDisplayFlags = display.getDisplayFlags();
+	display.setDisplayFlags(oldDisplayFlags & ~(LCD_FLAG_ALTERNATE_ROOM | LCD_FLAG_DISPLAY_ROOM));
+	rotaryEncoder.setRange(0, 0, 2); // mode setting, beer temp, fridge temp
+	showPage(MENU_TOP);
 }
 
-/**
- * @return {@code true} if a value was selected. {@code false} on timeout.
- */
-bool blinkLoop(
-	void (*changed)(), // called to update the value
-	void (*show)(),	// called to show the current value
-	void (*hide)(),	// called to blank out the current value
-	void (*pushed)())  // handle selection
+void Menu::pickMode(void)
 {
-	uint16_t lastChangeTime = ticks.seconds();
-	uint8_t blinkTimer = 0;
-
-	while (ticks.timeSince(lastChangeTime) < MENU_TIMEOUT)
-	{ // time out at 10 seconds
-		if (rotaryEncoder.changed())
-		{
-			lastChangeTime = ticks.seconds();
-			blinkTimer = 0;
-			changed();
-		}
-		if (blinkTimer == 0)
-			show();
-		else if (blinkTimer == 128)
-			hide();
-
-		if (rotaryEncoder.pushed())
-		{
-			rotaryEncoder.resetPushed();
-			show();
-			pushed();
-			return true;
-		}
-
-		blinkTimer++;
-		wait.millis(3); // delay for blinking
-	}
-	return false;
+	oldMode = tempControl.getMode();
+	pickedMode = oldMode;
+	const char *LOOKUP = "bfpo";
+	rotaryEncoder.setRange(indexOf(LOOKUP, oldMode), 0, 3); // toggle between beer constant, beer profile, fridge constant
+	showPage(MENU_MODE);
 }
 
-void clearSettingText()
+void Menu::pickBeerSetting(void)
 {
-	display.printAt_P(0, rotaryEncoder.read(), STR_6SPACES);
+	pickTempSetting(MENU_BEER_SETTING, tempControl.getBeerSetting());
 }
 
-void settingChanged() {} // no -op - the only change is to update the display which happens already
-
-void settingSelected()
-{
-	switch (rotaryEncoder.read())
-	{
-	case 0:
-		menu.pickMode();
-		return;
-	case 1:
-		// switch to beer constant, because beer setting will be set through display
-		tempControl.setMode(MODE_BEER_CONSTANT);
-		display.printMode();
-		menu.pickBeerSetting();
-		return;
-	case 2:
-		// switch to fridge constant, because fridge setting will be set through display
-		tempControl.setMode(MODE_FRIDGE_CONSTANT);
-		display.printMode();
-		menu.pickFridgeSetting();
-		return;
-	}
-}
-
-void Menu::pickSettingToChangeLoop(void)
+void Menu::pickFridgeSetting(void)
 {
-	rotaryEncoder.setRange(0, 0, 2); // mode setting, beer temp, fridge temp
-	blinkLoop(
-		settingChanged,
-		display.printStationaryText,
-		clearSettingText,
-		settingSelected);
+	pickTempSetting(MENU_FRIDGE_SETTING, tempControl.getFridgeSetting());
 }
 
-void changedMode()
+void Menu::pickTempSetting(menuPages newPage, temperature oldSetting)
 {
-	const char lookup[] = {'b', 'f', 'p', 'o'};
-	tempControl.setMode(lookup[rotaryEncoder.read()]);
+	pickedTemp = oldSetting;
+	if (isDisabledOrInvalid(oldSetting))
+	{ // previous temperature was not defined, start at 20C
+		pickedTemp = intToTemp(20);
+	}
+	rotaryEncoder.setRange(fixedToTenths(pickedTemp), fixedToTenths(tempControl.cc.tempSettingMin), fixedToTenths(tempControl.cc.tempSettingMax));
+	showPage(newPage);
 }
 
-void clearMode()
+// Switch to a page, restart the timeout and show the value
+void Menu::showPage(menuPages newPage)
 {
-	display.printAt_P(7, 0, PSTR("             ")); // print 13 spaces
+	page = newPage;
+	lastChangeTime = ticks.seconds();
+	blinkStartTime = ticks.millis();
+	blinkVisible = false;
+	blink(true);
 }
 
-void selectMode()
+/**
+ * Handles the encoder input of the active page. Each call returns immediately, so the control loop and serial
+ * communication keep running while the menu is shown. Encoder events are taken from the queue one per call. The menu
+ * closes without a change on a long press or when there is no input for 10 seconds.
+ */
+void Menu::update(void)
 {
-	char mode = tempControl.getMode();
-	if (mode == MODE_BEER_CONSTANT)
+	if (page == MENU_NONE)
 	{
-		menu.pickBeerSetting();
+		return;
 	}
-	else if (mode == MODE_FRIDGE_CONSTANT)
+	uint8_t event = rotaryEncoder.nextEvent();
+	if (event == ROTARY_EVENT_LONG_PRESS || (event == ROTARY_EVENT_NONE && ticks.timeSince(lastChangeTime) >= MENU_TIMEOUT))
 	{
-		menu.pickFridgeSetting();
+		cancel();
+		return;
 	}
-	else if (mode == MODE_BEER_PROFILE)
+	if (event != ROTARY_EVENT_NONE)
 	{
-		piLink.printBeerAnnotation(PSTR("Changed to profile mode in menu."));
+		lastChangeTime = ticks.seconds();
+		if (rotaryEncoder.isTurn(event))
+		{
+			changed();
+		}
+		blinkStartTime = ticks.millis();
+		blinkVisible = false;
+		blink(true);
+		if (event == ROTARY_EVENT_PUSH)
+		{
+			selected();
+		}
+		return;
 	}
-	else if (mode == MODE_OFF)
+	ticks_millis_t elapsed = ticks.millis() - blinkStartTime;
+	if (elapsed >= MENU_BLINK_PERIOD)
 	{
-		piLink.printBeerAnnotation(PSTR("Temp control turned off in menu."));
+		blinkStartTime += MENU_BLINK_PERIOD;
+		elapsed -= MENU_BLINK_PERIOD;
 	}
+	blink(elapsed < MENU_BLINK_PERIOD / 2);
 }
 
-void Menu::pickMode(void)
+// Show or blank out the value that is being changed. The display is only written when the visibility changes.
+void Menu::blink(bool visible)
 {
-	char oldSetting = tempControl.getMode();
-	uint8_t startValue = 0;
-	const char *LOOKUP = "bfpo";
-	startValue = indexOf(LOOKUP, oldSetting);
-	rotaryEncoder.setRange(startValue, 0, 3); // toggle between beer constant, beer profile, fridge constant
-
-	if (!blinkLoop(changedMode, display.printMode, clearMode, selectMode))
-		tempControl.setMode(oldSetting);
+	if (visible == blinkVisible)
+	{
+		return;
+	}
+	blinkVisible = visible;
+	switch (page)
+	{
+	case MENU_TOP:
+		if (visible)
+		{
+			display.printStationaryText();
+		}
+		else
+		{
+			display.printAt_P(0, rotaryEncoder.read(), STR_6SPACES);
+		}
+		break;
+	case MENU_MODE:
+		if (visible)
+		{
+			display.printMode();
+		}
+		else
+		{
+			display.printAt_P(7, 0, PSTR("             ")); // print 13 spaces
+			display.invalidate(LCD_FIELD_MODE);
+		}
+		break;
+	case MENU_BEER_SETTING:
+	case MENU_FRIDGE_SETTING:
+	{
+		uint8_t row = (page == MENU_BEER_SETTING) ? 1 : 2;
+		if (visible)
+		{
+			display.printTemperatureAt(12, row, pickedTemp);
+		}
+		else
+		{
+			display.printAt_P(12, row, STR_6SPACES); // only 5 needed, but 6 is okay to and lets us re-use the string
+		}
+		break;
+	}
+	default:
+		break;
+	}
 }
 
-typedef void (*PrintAnnotation)(const char *annotation, ...);
-typedef void (*DisplayUpdate)(void);
-typedef temperature (*ReadTemp)();
-typedef void (*WriteTemp)(temperature);
-
-void pickTempSetting(ReadTemp readTemp, WriteTemp writeTemp, const char *tempName, PrintAnnotation printAnnoation, int row)
+// The encoder was turned on the active page
+void Menu::changed(void)
 {
-
-	temperature oldSetting = readTemp();
-	temperature startVal = oldSetting;
-	temperature minVal = tempControl.cc.tempSettingMin;
-	temperature maxVal = tempControl.cc.tempSettingMax;
-	if (isDisabledOrInvalid(oldSetting))
-	{ // previous temperature was not defined, start at 20C
-		startVal = intToTemp(20);
+	switch (page)
+	{
+	case MENU_MODE:
+	{
+		const char lookup[] = {'b', 'f', 'p', 'o'};
+		pickedMode = lookup[rotaryEncoder.read()];
+		tempControl.setMode(pickedMode);
+		break;
 	}
+	case MENU_BEER_SETTING:
+	case MENU_FRIDGE_SETTING:
+		pickedTemp = tenthsToFixed(rotaryEncoder.read());
+		break;
+	default:
+		break; // the only change is to update the display which happens already
+	}
+}
 
-	rotaryEncoder.setRange(fixedToTenths(startVal), fixedToTenths(minVal), fixedToTenths(maxVal));
-
-	uint8_t blinkTimer = 0;
-	uint16_t lastChangeTime = ticks.seconds();
-	while (ticks.timeSince(lastChangeTime) < MENU_TIMEOUT)
-	{ // time out at 10 seconds
-		if (rotaryEncoder.changed())
+// The encoder was pushed on the active page
+void Menu::selected(void)
+{
+	char tempString[9];
+	switch (page)
+	{
+	case MENU_TOP:
+		switch (rotaryEncoder.read())
 		{
-			lastChangeTime = ticks.seconds();
-			blinkTimer = 0;
-			startVal = tenthsToFixed(rotaryEncoder.read());
-			display.printTemperatureAt(12, row, startVal);
-
-			if (rotaryEncoder.pushed())
-			{
-				rotaryEncoder.resetPushed();
-				writeTemp(startVal);
-				char tempString[9];
-				printAnnoation(PSTR("%S temp set to %s in Menu."), tempName, tempToString(tempString, startVal, 1, 9));
-				return;
-			}
+		case 0:
+			pickMode();
+			return;
+		case 1:
+			// switch to beer constant, because beer setting will be set through display
+			tempControl.setMode(MODE_BEER_CONSTANT);
+			display.printMode();
+			pickBeerSetting();
+			return;
+		case 2:
+			// switch to fridge constant, because fridge setting will be set through display
+			tempControl.setMode(MODE_FRIDGE_CONSTANT);
+			display.printMode();
+			pickFridgeSetting();
+			return;
 		}
-		else
+		break;
+	case MENU_MODE:
+		switch (tempControl.getMode())
 		{
-			if (blinkTimer == 0)
-			{
-				display.printTemperatureAt(12, row, startVal);
-			}
-			if (blinkTimer == 128)
-			{
-				display.printAt_P(12, row, STR_6SPACES); // only 5 needed, but 6 is okay to and lets us re-use the string
-			}
-			blinkTimer++;
-			wait.millis(3); // delay for blinking
+		case MODE_BEER_CONSTANT:
+			pickBeerSetting();
+			return;
+		case MODE_FRIDGE_CONSTANT:
+			pickFridgeSetting();
+			return;
+		case MODE_BEER_PROFILE:
+			piLink.printBeerAnnotation(PSTR("Changed to profile mode in menu."));
+			break;
+		case MODE_OFF:
+			piLink.printBeerAnnotation(PSTR("Temp control turned off in menu."));
+			break;
 		}
+		break;
+	case MENU_BEER_SETTING:
+		tempControl.setBeerTemp(pickedTemp);
+		piLink.printBeerAnnotation(PSTR("%S temp set to %s in Menu."), PSTR("Beer"), tempToString(tempString, pickedTemp, 1, 9));
+		break;
+	case MENU_FRIDGE_SETTING:
+		tempControl.setFridgeTemp(pickedTemp);
+		piLink.printFridgeAnnotation(PSTR("%S temp set to %s in Menu."), PSTR("Fridge"), tempToString(tempString, pickedTemp, 1, 9));
+		break;
+	default:
+		break;
 	}
-	// Time Out. Setting is not written
+	close();
 }
 
-void Menu::pickFridgeSetting(void)
+// A long press or the timeout leaves the menu without changing the setting that is being picked.
+// The old mode is only restored when the mode is still the one picked in the menu, a mode set over serial is kept.
+void Menu::cancel(void)
 {
-	pickTempSetting(tempControl.getFridgeSetting, tempControl.setFridgeTemp, PSTR("Fridge"), piLink.printFridgeAnnotation, 2);
+	if (page == MENU_MODE && tempControl.getMode() == pickedMode)
+	{
+		tempControl.setMode(oldMode);
+	}
+	close(); // a temperature setting that was not selected is not written
 }
 
-void Menu::pickBeerSetting(void)
+void Menu::close(void)
 {
-	pickTempSetting(tempControl.getBeerSetting, tempControl.setBeerTemp, PSTR("Beer"), piLink.printBeerAnnotation, 1);
+	page = MENU_NONE;
+	display.setDisplayFlags(oldDisplayFlags);
+	display.printMode();
 }
 
 #endif
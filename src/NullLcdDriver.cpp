@@ -60,6 +60,7 @@ void NullLcdDriver::clear()
 		}
 		content[i][20] = '\0'; // NULL terminate string
 	}
+	_contentVersion++;
 }
 
 void NullLcdDriver::home()
@@ -170,7 +171,12 @@ inline void NullLcdDriver::command(uint8_t value)
 
 size_t NullLcdDriver::write(uint8_t value)
 {
-	content[_currline][_currpos] = value;
+	char &cell = content[_currline][_currpos];
+	if (cell != char(value))
+	{
+		cell = value;
+		_contentVersion++;
+	}
 	_currpos++;
 	return 1;
 }
@@ -34,6 +34,9 @@ license and credits. */
 #include <string.h>
 #include <inttypes.h>
 
+// DDRAM address of the first character of each line
+static const uint8_t lineOffsets[] = {0x00, 0x40, 0x14, 0x54};
+
 void OLEDFourBit::init(uint8_t rs, uint8_t rw, uint8_t enable,
 					   uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7)
 {
@@ -52,6 +55,14 @@ void OLEDFourBit::init(uint8_t rs, uint8_t rw, uint8_t enable,
 	pinMode(_enable_pin, OUTPUT);
 
 	_displayfunction = LCD_FUNCTIONSET | LCD_4BITMODE;
+
+	queue.reset();
+	_busyTiming = OLED_NOT_BUSY;
+	_busyFlagWorks = true; // only cleared by repeated timeouts, a display that cannot be read stays on fixed delays
+	_busyTimeouts = 0;
+#if BREWPI_LOOP_STATS
+	resetTimingStats();
+#endif
 }
 
 void OLEDFourBit::begin(uint8_t cols, uint8_t lines)
@@ -60,6 +71,23 @@ void OLEDFourBit::begin(uint8_t cols, uint8_t lines)
 	_currline = 0;
 	_currpos = 0;
 
+	initInterface();
+
+	clear(); // display clear
+
+	// Entry Mode Set:
+	leftToRight();
+	noAutoscroll();
+
+	home();
+
+	noCursor();
+	display();
+}
+
+// Queue the sequence that puts the display in 4 bit mode and turns it off
+void OLEDFourBit::initInterface()
+{
 	pinMode(_rs_pin, OUTPUT);
 	pinMode(_rw_pin, OUTPUT);
 	pinMode(_enable_pin, OUTPUT);
@@ -76,42 +104,43 @@ void OLEDFourBit::begin(uint8_t cols, uint8_t lines)
 	}
 
 	// SEE PAGE 20 of NHD-0420DZW-AY5
-	delayMicroseconds(50000); // wait 50 ms just to be sure tha the lcd is initialized
-
-	delayMicroseconds(32000);
-	write4bits(0x03);
-	delayMicroseconds(32000);
-	write4bits(0x03);
-	delayMicroseconds(32000);
-	write4bits(0x03);
+	// The sequence and its delays are queued and sent by processQueue(), so it doesn't block the main loop.
+	// The busy flag cannot be read while the interface is in an unknown mode, so the nibbles use fixed delays.
+	_busyTiming = OLED_NOT_BUSY;
+	enqueue(0x00, LCD_QUEUE_NOP | 50); // wait 50 ms just to be sure tha the lcd is initialized
 
-	delayMicroseconds(32000);
-	write4bits(0x02);
-	delayMicroseconds(10000);
-	write4bits(0x02);
-	delayMicroseconds(10000);
-	write4bits(0x08);
+	enqueue(0x00, LCD_QUEUE_NOP | 32);
+	enqueue(0x03, LCD_QUEUE_NIBBLE | 32);
+	enqueue(0x03, LCD_QUEUE_NIBBLE | 32);
+	enqueue(0x03, LCD_QUEUE_NIBBLE | 32);
 
-	waitBusy();
+	enqueue(0x02, LCD_QUEUE_NIBBLE | 10);
+	enqueue(0x02, LCD_QUEUE_NIBBLE | 10);
+	enqueue(0x08, LCD_QUEUE_NIBBLE); // completes a function set in 4 bit mode, from here on the busy flag is polled
 
 	noDisplay(); // Display off
+}
 
-	clear(); // display clear
-
-	// Entry Mode Set:
-	leftToRight();
-	noAutoscroll();
-
-	home();
-
-	noCursor();
+// Initialize the display again after corruption was detected. Unlike begin(), the shadow copy is kept and sent again.
+void OLEDFourBit::reinitialize()
+{
+	queue.reset();
+	initInterface();
+	command(LCD_CLEARDISPLAY);
+	command(LCD_ENTRYMODESET | _displaymode);
 	display();
+	for (uint8_t line = 0; line < 4; line++)
+	{
+		queue.markLineChanged(line);
+	}
 }
 
 /********** high level commands, for the user! */
 void OLEDFourBit::clear()
 {
 	command(LCD_CLEARDISPLAY); // clear display, set cursor position to zero
+	queue.clearChanged();
+	_contentVersion++;
 
 	for (uint8_t i = 0; i < 4; i++)
 	{
@@ -130,16 +159,15 @@ void OLEDFourBit::home()
 	_currpos = 0;
 }
 
+// The cursor is only moved on the display when a character that differs from the shadow copy is written, see write()
 void OLEDFourBit::setCursor(uint8_t col, uint8_t row)
 {
-	uint8_t row_offsets[] = {0x00, 0x40, 0x14, 0x54};
 	if (row >= _numlines)
 	{
 		row = 0; //write to first line if out off bounds
 	}
 	_currline = row;
 	_currpos = col;
-	command(LCD_SETDDRAMADDR | (col + row_offsets[row]));
 }
 
 // Turn the display on/off (quickly)
@@ -224,7 +252,7 @@ void OLEDFourBit::createChar(uint8_t location, uint8_t charmap[])
 	command(LCD_SETCGRAMADDR | (location << 3));
 	for (int i = 0; i < 8; i++)
 	{
-		write(charmap[i]);
+		enqueue(charmap[i], LCD_QUEUE_DATA); // CGRAM data, not part of the shadow copy
 	}
 }
 
@@ -232,19 +260,225 @@ void OLEDFourBit::createChar(uint8_t location, uint8_t charmap[])
 
 inline void OLEDFourBit::command(uint8_t value)
 {
-	send(value, LOW);
-	waitBusy();
+	enqueue(value, 0);
 }
 
+// Add a byte to the command queue. When the queue is full, wait until the display has taken the oldest one.
+void OLEDFourBit::enqueue(uint8_t value, uint8_t flags)
+{
+	while (!queue.push(value, flags))
+	{
+		processQueue();
+	}
+}
+
+// Only characters that differ from the shadow copy are marked to be sent by processQueue().
+// Characters beyond the end of the line are dropped, they would end up on another line of the display.
 inline size_t OLEDFourBit::write(uint8_t value)
 {
-	send(value, HIGH);
-	content[_currline][_currpos] = value;
+	if (_currpos >= 20)
+	{
+		return 1;
+	}
+	char &cell = content[_currline][_currpos];
+	if (cell != char(value))
+	{
+		cell = value;
+		_contentVersion++;
+		queue.markChanged(_currline, _currpos);
+	}
 	_currpos++;
-	waitBusy();
 	return 1;
 }
 
+// Called from the main loop. Sends at most one byte: queued commands first, then the changed characters of the shadow
+// copy in display order. The address command is only sent when the display cursor is not already at the right position,
+// so a run of changed characters costs a single address command.
+void OLEDFourBit::processQueue(void)
+{
+	if (!busyDone(0) || !queue.ready())
+	{
+		return;
+	}
+	uint8_t value, flags;
+	if (queue.pop(value, flags))
+	{
+		transmit(value, flags);
+		return;
+	}
+	uint8_t line, pos;
+	if (!queue.nextChanged(line, pos))
+	{
+		return;
+	}
+	uint8_t address = lineOffsets[line] + pos;
+	if (address != queue.displayAddress())
+	{
+		transmit(LCD_SETDDRAMADDR | address, 0);
+		return;
+	}
+	queue.markSent(line, pos);
+	transmit(content[line][pos], LCD_QUEUE_DATA);
+}
+
+// Send all pending commands and characters, for when the display has to be in sync before it is read
+void OLEDFourBit::flush(void)
+{
+	while (!queue.idle())
+	{
+		processQueue();
+	}
+	waitReady();
+}
+
+// Wait until the display finished the last byte, for reading it back right after sending a command
+void OLEDFourBit::waitReady(void)
+{
+	busyDone(OLED_BUSY_TIMEOUT_MICROS);
+	while (!queue.ready())
+	{
+	}
+}
+
+// Reads one line back from the display on each call and compares it with the shadow copy. The display is only
+// initialized again when they differ, which is reported by returning true.
+// Nothing is read while output is pending, the display would not match the shadow copy yet. Nothing is read either when
+// the busy flag cannot be read, then the data pins cannot be read back and every line would look corrupt.
+bool OLEDFourBit::checkContent(void)
+{
+	if (!_busyFlagWorks || !queue.idle() || !busyDone(0) || !queue.ready())
+	{
+		return false;
+	}
+	uint8_t line = _checkLine;
+	_checkLine = (line + 1) & 3;
+	transmit(LCD_SETDDRAMADDR | lineOffsets[line], 0);
+	waitReady();
+	bool corrupt = false;
+	for (uint8_t i = 0; i < 20; i++)
+	{
+		if (readChar() != content[line][i])
+		{
+			corrupt = true;
+		}
+	}
+	queue.invalidateAddress();
+	if (corrupt)
+	{
+		reinitialize();
+	}
+	return corrupt;
+}
+
+// Full bytes are followed by polling the busy flag, so the next byte is sent as soon as the display has processed it.
+// Queued delays are only used during initialization, and fixed delays only when the busy flag cannot be read.
+void OLEDFourBit::transmit(uint8_t value, uint8_t flags)
+{
+	uint8_t type = flags & LCD_QUEUE_NOP;
+	if (type == LCD_QUEUE_NIBBLE)
+	{
+		digitalWrite(_rs_pin, LOW); // initialization nibbles are commands
+		write4bits(value);
+	}
+	else if (type != LCD_QUEUE_NOP)
+	{
+		send(value, (type == LCD_QUEUE_DATA) ? HIGH : LOW);
+	}
+	queue.sent(value, flags, _displaymode == LCD_ENTRYLEFT);
+	if (type == LCD_QUEUE_NOP || (flags & LCD_QUEUE_DELAY_MASK))
+	{
+		return;
+	}
+	uint8_t timing = OLED_TIMING_COMMAND;
+	if (type == LCD_QUEUE_DATA)
+	{
+		timing = OLED_TIMING_DATA;
+	}
+	else if (type == 0 && (value == LCD_CLEARDISPLAY || value == LCD_RETURNHOME))
+	{
+		timing = OLED_TIMING_CLEAR;
+	}
+	if (!_busyFlagWorks)
+	{
+		queue.holdOff(timing == OLED_TIMING_CLEAR ? OLED_CLEAR_DELAY : OLED_BYTE_DELAY);
+		return;
+	}
+	_busyTiming = timing;
+	_busySince = ticks.micros();
+	// Most bytes are done within the spin, the others are polled again from the main loop. Clear and home are rare and
+	// take milliseconds, they are polled until done so their time is measured.
+	busyDone(timing == OLED_TIMING_CLEAR ? OLED_BUSY_TIMEOUT_MICROS : OLED_BUSY_SPIN_MICROS);
+}
+
+// Returns true when the display has processed the last byte. The busy flag is polled until it clears or until spinMicros
+// have passed since the byte was sent. When it does not clear within OLED_BUSY_TIMEOUT_MICROS for OLED_BUSY_TIMEOUT_LIMIT
+// bytes in a row, the flag is assumed to be unreadable and fixed delays are used from then on. A single timeout only
+// holds off the next byte, for a display that missed a byte or was busy for longer than expected.
+bool OLEDFourBit::busyDone(uint16_t spinMicros)
+{
+	if (_busyTiming == OLED_NOT_BUSY)
+	{
+		return true;
+	}
+	uint8_t status = waitBusy(spinMicros);
+	ticks_micros_t elapsed = ticks.micros() - _busySince;
+	if (status == OLED_BUSY)
+	{
+		if (elapsed < OLED_BUSY_TIMEOUT_MICROS)
+		{
+			return false;
+		}
+		if (++_busyTimeouts >= OLED_BUSY_TIMEOUT_LIMIT)
+		{
+			_busyFlagWorks = false;
+		}
+		queue.holdOff(OLED_CLEAR_DELAY);
+	}
+	else
+	{
+		_busyTimeouts = 0;
+	}
+#if BREWPI_LOOP_STATS
+	// With spinMicros 0, the call comes from the main loop. When the flag was already clear at its first read, the byte
+	// was done at some point since the previous poll, so the elapsed time is not the controller time.
+	if (spinMicros != 0 || status != OLED_READY_AT_FIRST_READ)
+	{
+		recordTiming(_busyTiming, elapsed, status == OLED_BUSY);
+	}
+#endif
+	_busyTiming = OLED_NOT_BUSY;
+	return true;
+}
+
+#if BREWPI_LOOP_STATS
+void OLEDFourBit::recordTiming(uint8_t timingClass, ticks_micros_t elapsed, bool timedOut)
+{
+	OLEDTimingStats &t = _timing[timingClass];
+	if (timedOut)
+	{
+		t.timeouts++;
+		return;
+	}
+	// below OLED_BUSY_TIMEOUT_MICROS plus a spin, limited in case the timeout is raised
+	uint16_t micros = (elapsed > 0xFFFF) ? 0xFFFF : uint16_t(elapsed);
+	if (t.count == 0xFFFF)
+	{
+		t.count >>= 1;
+		t.sum >>= 1;
+	}
+	if (t.count == 0 || micros < t.min)
+	{
+		t.min = micros;
+	}
+	if (micros > t.max)
+	{
+		t.max = micros;
+	}
+	t.sum += micros;
+	t.count++;
+}
+#endif
+
 /************ low level data pushing commands **********/
 
 // write either command or data
@@ -261,7 +495,10 @@ void OLEDFourBit::send(uint8_t value, uint8_t mode)
 void OLEDFourBit::pulseEnable(void)
 {
 	digitalWrite(_enable_pin, HIGH);
-	delayMicroseconds(100); // enable pulse must be >450ns
+	// The enable pulse must be >450ns and the enable cycle >1000ns (HD44780U datasheet, bus timing characteristics,
+	// PWEH and tcycE at 2.7-4.5V, the slower of its two supply ranges). The time the display needs to execute a byte
+	// is covered by polling the busy flag, or by the queue hold-off when it cannot be read.
+	delayMicroseconds(1);
 	digitalWrite(_enable_pin, LOW);
 }
 
@@ -272,38 +509,46 @@ void OLEDFourBit::write4bits(uint8_t value)
 		pinMode(_data_pins[i], OUTPUT);
 		digitalWrite(_data_pins[i], (value >> i) & 0x01);
 	}
-	delayMicroseconds(100);
-	pulseEnable();
+	pulseEnable(); // digitalWrite() takes longer than the data setup time
 }
 
-void OLEDFourBit::waitBusy(void)
+// Polls the busy flag until it is cleared or timeoutMicros have passed since the byte was sent. The flag is read at least
+// once. Returns an OLEDBusyStatus.
+uint8_t OLEDFourBit::waitBusy(uint16_t timeoutMicros)
 {
-	uint8_t busy = 1;
+	bool busy;
+	bool polled = false; // the flag was seen set
 	pinMode(_busy_pin, INPUT);
 	digitalWrite(_rs_pin, LOW);
 	digitalWrite(_rw_pin, HIGH);
-	uint8_t tries = 0;
 	do
 	{
-		digitalWrite(_enable_pin, LOW);
 		digitalWrite(_enable_pin, HIGH);
-		delayMicroseconds(10);
+		delayMicroseconds(1);
 		busy = digitalRead(_busy_pin);
 		digitalWrite(_enable_pin, LOW);
 		pulseEnable(); // get remaining 4 bits, which are not used.
-		tries++;
-		if (tries > 200)
-		{
-			break;
-		}
-	} while (busy);
+		polled |= busy;
+	} while (busy && ticks.micros() - _busySince < timeoutMicros);
 
 	pinMode(_busy_pin, OUTPUT);
 	digitalWrite(_rw_pin, LOW);
+	return busy ? OLED_BUSY : polled ? OLED_READY_AFTER_POLLING : OLED_READY_AT_FIRST_READ;
 }
 
+// Reads the character at the address counter. The display increments the address after each read, so the busy flag is
+// polled before reading, which takes a few microseconds instead of a fixed delay. Each nibble is read while enable is high.
 char OLEDFourBit::readChar(void)
 {
+	if (_busyFlagWorks)
+	{
+		_busySince = ticks.micros();
+		waitBusy(OLED_BUSY_SPIN_MICROS);
+	}
+	else
+	{
+		delayMicroseconds(OLED_READ_DELAY_MICROS);
+	}
 	char value = 0x00;
 	for (int i = 0; i < 4; i++)
 	{
@@ -311,17 +556,15 @@ char OLEDFourBit::readChar(void)
 	}
 	digitalWrite(_rs_pin, HIGH);
 	digitalWrite(_rw_pin, HIGH);
-	pulseEnable();
-	delayMicroseconds(600);
-	for (int i = 0; i < 4; i++)
-	{
-		value = value | (digitalRead(_data_pins[i]) << (i + 4));
-	}
-	pulseEnable();
-	delayMicroseconds(600);
-	for (int i = 0; i < 4; i++)
+	for (int shift = 4; shift >= 0; shift -= 4)
 	{
-		value = value | (digitalRead(_data_pins[i]) << (i));
+		digitalWrite(_enable_pin, HIGH);
+		delayMicroseconds(1); // data is valid well within 1 us after enable goes high
+		for (int i = 0; i < 4; i++)
+		{
+			value = value | (digitalRead(_data_pins[i]) << (i + shift));
+		}
+		digitalWrite(_enable_pin, LOW);
 	}
 	return value;
 }
@@ -341,7 +584,9 @@ void OLEDFourBit::getLine(uint8_t lineNumber, char *buffer)
 // Buffer should always stay up to date, so this function is not really needed.
 void OLEDFourBit::readContent(void)
 {
-	setCursor(0, 0);
+	flush();
+	transmit(LCD_SETDDRAMADDR | 0x00, 0);
+	waitReady();
 	for (uint8_t i = 0; i < 20; i++)
 	{
 		content[0][i] = readChar();
@@ -350,7 +595,8 @@ void OLEDFourBit::readContent(void)
 	{
 		content[2][i] = readChar();
 	}
-	setCursor(0, 1);
+	transmit(LCD_SETDDRAMADDR | 0x40, 0);
+	waitReady();
 	for (uint8_t i = 0; i < 20; i++)
 	{
 		content[1][i] = readChar();
@@ -359,6 +605,8 @@ void OLEDFourBit::readContent(void)
 	{
 		content[3][i] = readChar();
 	}
+	queue.invalidateAddress();
+	_contentVersion++;
 }
 
 void OLEDFourBit::printSpacesToRestOfLine(void)
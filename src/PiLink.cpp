@@ -46,6 +46,10 @@ license and credits. */
 #include "PiLinkHandlers.h"
 #include "UI.h"
 #include "Actuator.h"
+#include "LoopStats.h"
+#include "MemoryStats.h"
+#include "DevicePool.h"
+#include "StreamParse.h"
 
 #if BREWPI_SIMULATE
 #include "Simulator.h"
@@ -213,10 +217,37 @@ void PiLink::receive(void)
 			}
 			printNewLine();
 			break;
+#if BREWPI_VIRTUAL_LCD
+		case 'g': // frame log of the virtual display requested
+			sendVirtualLcdFrames();
+			break;
+#endif
+		case 'k': // Display content requested when it changed since the version sent by the client
+			sendDisplaySnapshot();
+			break;
 		case 'j': // Receive settings as json
 			receiveJson();
 			break;
 
+#if BREWPI_RAM_STATS
+		case 'r': // RAM usage requested
+			sendRamStats();
+			break;
+#endif
+
+#if BREWPI_LOOP_STATS
+		case 'm': // loop timing statistics requested
+			sendLoopStats();
+			break;
+		case 'M': // reset loop timing statistics
+			LoopStats::reset();
+			display.resetFieldStats();
+#if LCD_DRIVER_TIMING_STATS
+			display.getLcd().resetTimingStats();
+#endif
+			break;
+#endif
+
 #if BREWPI_EEPROM_HELPER_COMMANDS
 		case 'e': // dump contents of eeprom
 			openListResponse('E');
@@ -376,7 +407,7 @@ void PiLink::printTemperaturesJSON(char *beerAnnotation, char *fridgeAnnotation)
 
 #if BREWPI_SIMULATE
 	printJsonName(PSTR(JSON_TIME));
-	print_P(PSTR("%lu"), ticks.millis() / 1000);
+	print_P(PSTR("%lu"), divideBy1000(ticks.millis()));
 #endif
 	sendJsonClose();
 }
@@ -424,6 +455,88 @@ void PiLink::printFridgeAnnotation(const char *annotation, ...)
 	printTemperaturesJSON(0, tempString);
 }
 
+#if BREWPI_RAM_STATS
+// Sends the RAM usage in bytes (see MemoryStats.h) and the device pools as [used,peak,capacity,failed]:
+// r:{"free":412,"largest":380,"watermark":198,"stack":243,"pools":[[2,2,2,0],[3,3,3,0],[3,4,4,0],[3,3,4,0],[1,1,1,0]]}
+void PiLink::sendRamStats(void)
+{
+	RamStats stats;
+	MemoryStats::read(stats);
+	print_P(PSTR("r:{\"free\":%u,\"largest\":%u,\"watermark\":%u,\"stack\":%u"),
+			stats.freeRam, stats.largestBlock, stats.stackWatermark, stats.stackMax);
+#if BREWPI_DEVICE_POOLS
+	print_P(PSTR(",\"pools\":["));
+	for (uint8_t i = 0; i < NUM_DEVICE_POOLS; i++)
+	{
+		const DevicePoolStats &pool = devicePoolStats(i);
+		print_P(PSTR("%s[%u,%u,%u,%u]"), i ? "," : "", pool.used, pool.peak, pool.capacity, pool.failed);
+	}
+	piStream.print(']');
+#endif
+	piStream.print('}');
+	printNewLine();
+}
+#endif
+
+#if BREWPI_LOOP_STATS
+// Sends min/max/mean in microseconds and the log2 histogram (see LoopStats.h) of each loop phase:
+// m:[{"p":"temps","n":60,"min":1800,"max":2100,"avg":1900,"h":[0,0,0,0,0,0,60,0,0,0,0,0]},...,{"p":"fields","drawn":90,"skipped":270},{"p":"lcd-data","n":900,"min":60,"max":120,"avg":70,"timeouts":0},...]
+void PiLink::sendLoopStats(void)
+{
+	openListResponse('m');
+	for (uint8_t phase = 0; phase < NUM_LOOP_PHASES; phase++)
+	{
+		const LoopPhaseStats &s = LoopStats::get(phase);
+		print_P(PSTR("%s{\"p\":\"" PRINTF_PROGMEM "\",\"n\":%u,\"min\":%lu,\"max\":%lu,\"avg\":%lu,\"h\":["),
+				phase ? "," : "", LoopStats::name(phase), s.count, s.min, s.max, s.count ? s.sum / s.count : 0ul);
+		for (uint8_t i = 0; i < LOOP_STATS_BUCKETS; i++)
+		{
+			print_P(PSTR("%s%u"), i ? "," : "", s.buckets[i]);
+		}
+		print_P(PSTR("]}"));
+	}
+	// display fields that were drawn and that were skipped because their value was unchanged, see LcdDisplay
+	print_P(PSTR(",{\"p\":\"fields\",\"drawn\":%u,\"skipped\":%u}"), display.getFieldsDrawn(), display.getFieldsSkipped());
+#if LCD_DRIVER_TIMING_STATS
+	// time until the busy flag of the lcd cleared, per kind of byte, and the number of times it did not clear
+	static const char timingNames[OLED_TIMING_CLASSES][6] PROGMEM = {"clear", "cmd", "data"};
+	for (uint8_t i = 0; i < OLED_TIMING_CLASSES; i++)
+	{
+		const OLEDTimingStats &t = display.getLcd().timingStats(i);
+		print_P(PSTR(",{\"p\":\"lcd-" PRINTF_PROGMEM "\",\"n\":%u,\"min\":%u,\"max\":%u,\"avg\":%lu,\"timeouts\":%u}"),
+				timingNames[i], t.count, t.min, t.max, t.count ? t.sum / t.count : 0ul, t.timeouts);
+	}
+#endif
+	closeListResponse();
+}
+#endif
+
+#if BREWPI_VIRTUAL_LCD
+// Sends the counters and the frame log of the virtual display (see VirtualLcd.h), oldest frame first:
+// G:{"frames":120,"chars":1800,"changed":240,"commands":480,"log":[{"t":1000,"chars":15,"changed":2,"commands":4,"lines":[...]},...]}
+void PiLink::sendVirtualLcdFrames(void)
+{
+	VirtualLcd &lcd = display.getLcd();
+	const VirtualLcdStats &stats = lcd.stats();
+	printResponse('G');
+	print_P(PSTR("{\"frames\":%lu,\"chars\":%lu,\"changed\":%lu,\"commands\":%lu,\"log\":["),
+			stats.frames, stats.chars, stats.changed, stats.commands);
+	for (uint8_t i = 0; i < lcd.frameCount(); i++)
+	{
+		const VirtualLcdFrame &frame = lcd.frame(i);
+		print_P(PSTR("%s{\"t\":%lu,\"chars\":%u,\"changed\":%u,\"commands\":%u,\"lines\":["),
+				i ? "," : "", frame.time, frame.chars, frame.changed, frame.commands);
+		for (uint8_t line = 0; line < 4; line++)
+		{
+			print_P(PSTR("%s\"%s\""), line ? "," : "", frame.content[line]);
+		}
+		print_P(PSTR("]}"));
+	}
+	print_P(PSTR("]}"));
+	printNewLine();
+}
+#endif
+
 void PiLink::printResponse(char type)
 {
 	piStream.print(type);
@@ -677,6 +790,39 @@ int readNext()
 	}
 	return piStream.read();
 }
+
+// Time to wait for each byte of the snapshot version, in steps of 100 us. A byte takes 174 us at 57600 baud.
+#define SNAPSHOT_VERSION_RETRIES 20
+
+/*
+ * Sends the display content only when it changed since the version the client has, so frequent polls of an unchanged
+ * display cost a few bytes. The client sends the version of its last snapshot followed by a newline, or only a newline
+ * to get the content anyway. A version that is not terminated within SNAPSHOT_VERSION_RETRIES is ignored.
+ * k1234\n -> K:{"s":1234} when unchanged
+ *          -> K:{"s":1240,"l":["line 1","line 2","line 3","line 4"]} when changed
+ */
+void PiLink::sendDisplaySnapshot(void)
+{
+	uint16_t clientVersion;
+	// the version is usually still arriving when 'k' is handled
+	bool hasVersion = readTerminatedNumber(piStream, wait, SNAPSHOT_VERSION_RETRIES, clientVersion);
+	uint16_t version = display.getContentVersion();
+	printResponse('K');
+	print_P(PSTR("{\"s\":%u"), version);
+	if (!hasVersion || clientVersion != version)
+	{
+		char stringBuffer[21];
+		print_P(PSTR(",\"l\":["));
+		for (uint8_t i = 0; i < 4; i++)
+		{
+			display.getLine(i, stringBuffer);
+			print_P(PSTR("%s\"%s\""), i ? "," : "", stringBuffer);
+		}
+		piStream.print(']');
+	}
+	sendJsonClose();
+}
+
 /**
  * Parses a token from the piStream.
  * \return true if a token was parsed
@@ -61,13 +61,12 @@ license and credits. */
 #error Rotary encoder code is not compatible with boards other than leonardo or uno yet.
 #endif
 
-#include "util/atomic.h"
 #include "FastDigitalPin.h"
 
 #if BREWPI_STATIC_CONFIG == BREWPI_SHIELD_DIY
 ISR(INT2_vect)
 {
-    rotaryEncoder.setPushed();
+    rotaryEncoder.processButton(!bitRead(PIND, 2));
 }
 ISR(INT3_vect)
 {
@@ -84,7 +83,7 @@ ISR(INT1_vect)
 #elif BREWPI_BOARD == BREWPI_BOARD_LEONARDO
 ISR(INT6_vect)
 {
-    rotaryEncoder.setPushed();
+    rotaryEncoder.processButton(!bitRead(PINE, 6));
 }
 ISR(PCINT0_vect)
 {
@@ -95,11 +94,8 @@ ISR(PCINT0_vect)
 #elif BREWPI_BOARD == BREWPI_BOARD_STANDARD
 ISR(PCINT2_vect)
 {
-    if (!bitRead(PIND, 7))
-    {
-        // high to low transition
-        rotaryEncoder.setPushed();
-    }
+    // the button is pressed when the pin is low
+    rotaryEncoder.processButton(!bitRead(PIND, 7));
 }
 ISR(PCINT0_vect)
 {
@@ -120,12 +116,11 @@ void RotaryEncoder::init(void)
     fastPinMode(rotarySwitchPin, BREWPI_INPUT_PULLUP);
 
 #if BREWPI_STATIC_CONFIG == BREWPI_SHIELD_DIY
-    EICRA |= (1 << ISC21) | (1 << ISC10) | (1 << ISC30);
-    ;                                                 // any logical change for encoder pins, falling edge for switch
+    EICRA |= (1 << ISC20) | (1 << ISC10) | (1 << ISC30); // any logical change for encoder pins and switch
     EIMSK |= (1 << INT2) | (1 << INT1) | (1 << INT3); // enable interrupts for each pin
 #elif BREWPI_BOARD == BREWPI_BOARD_LEONARDO
-    // falling edge interrupt for switch on INT6
-    EICRB |= (1 << ISC61) | (0 << ISC60);
+    // any logical change interrupt for switch on INT6, to detect both press and release
+    EICRB |= (0 << ISC61) | (1 << ISC60);
     // enable interrupt for INT6
     EIMSK |= (1 << INT6);
     // enable pin change interrupts
@@ -146,24 +141,9 @@ void RotaryEncoder::init(void)
 void RotaryEncoder::setRange(int16_t start, int16_t minVal, int16_t maxVal)
 {
 #if BREWPI_ROTARY_ENCODER
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
-    {
-        // this part cannot be interrupted
-        // Multiply by two to convert to half steps
-        steps = start;
-        minimum = minVal;
-        maximum = maxVal; // +1 to make sure that one step is still two half steps at overflow
-    }
+    // the value is only changed by nextEvent() in the main loop, so this does not need to be atomic
+    steps = start;
+    minimum = minVal;
+    maximum = maxVal;
 #endif
 }
-
-int16_t RotaryEncoder::read(void)
-{
-#if BREWPI_ROTARY_ENCODER
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
-    {
-        return steps;
-    }
-#endif
-    return 0;
-}
@@ -40,8 +40,24 @@ RotaryEncoder rotaryEncoder;
 
 int16_t RotaryEncoder::maximum;
 int16_t RotaryEncoder::minimum;
-volatile int16_t RotaryEncoder::steps;
-volatile bool RotaryEncoder::pushFlag;
+int16_t RotaryEncoder::steps;
+volatile uint8_t RotaryEncoder::events[ROTARY_EVENT_QUEUE_SIZE];
+volatile uint8_t RotaryEncoder::eventHead;
+volatile uint8_t RotaryEncoder::eventTail;
+uint8_t RotaryEncoder::lastDir;
+uint16_t RotaryEncoder::lastStepTime;
+uint16_t RotaryEncoder::lastButtonTime;
+bool RotaryEncoder::buttonDown;
+
+// Steps in the same direction that follow each other faster than these intervals (in ms) count as multiple steps
+#define ROTARY_FAST_STEP_MILLIS 25
+#define ROTARY_MEDIUM_STEP_MILLIS 50
+#define ROTARY_SLOW_STEP_MILLIS 100
+// Acceleration is only applied when the range is large, like temperature settings in tenths of degrees
+#define ROTARY_ACCELERATION_MIN_RANGE 50
+// Button edges within this time of the previous press or release are switch bounce
+#define ROTARY_DEBOUNCE_MILLIS 30
+#define ROTARY_LONG_PRESS_MILLIS 1000
 
 // Implementation based on work of Ben Buxton:
 
@@ -184,36 +200,80 @@ void RotaryEncoder::process(uint8_t currPinA, uint8_t currPinB)
 
     if (dir)
     {
-        int16_t s = steps; // steps is volatile - save a copy here to avoid multiple fetches
-        s = (dir == DIR_CW) ? s + 1 : s - 1;
-        if (s > maximum)
-            s = minimum;
-        else if (s < minimum)
-            s = maximum;
-        steps = s;
+        uint16_t now = ticks.millis();
+        uint16_t interval = now - lastStepTime;
+        lastStepTime = now;
+        uint8_t count = 1;
+        if (dir == lastDir)
+        {
+            if (interval < ROTARY_FAST_STEP_MILLIS)
+                count = 10;
+            else if (interval < ROTARY_MEDIUM_STEP_MILLIS)
+                count = 5;
+            else if (interval < ROTARY_SLOW_STEP_MILLIS)
+                count = 2;
+        }
+        lastDir = dir;
+        // DIR_CW and DIR_CCW are 0x10 and 0x20, shifted they are the event types
+        queueEvent((dir << 2) | count);
+    }
+}
+
+// The push is reported when the button is released, so a long press can be told apart from a short one
+void RotaryEncoder::processButton(bool pressed)
+{
+    uint16_t now = ticks.millis();
+    uint16_t sinceLastEdge = now - lastButtonTime;
+    if (sinceLastEdge < ROTARY_DEBOUNCE_MILLIS)
+    {
+        return;
+    }
+    if (pressed)
+    {
+        buttonDown = true;
+        lastButtonTime = now;
         display.resetBacklightTimer();
     }
+    else if (buttonDown)
+    {
+        buttonDown = false;
+        lastButtonTime = now;
+        queueEvent(sinceLastEdge >= ROTARY_LONG_PRESS_MILLIS ? ROTARY_EVENT_LONG_PRESS : ROTARY_EVENT_PUSH);
+    }
 }
 
-void RotaryEncoder::setPushed(void)
+void RotaryEncoder::queueEvent(uint8_t event)
 {
-    pushFlag = true;
+    uint8_t head = eventHead;
+    uint8_t next = (head + 1) & (ROTARY_EVENT_QUEUE_SIZE - 1);
+    if (next != eventTail) // when the queue is full the event is dropped
+    {
+        events[head] = event;
+        eventHead = next;
+    }
     display.resetBacklightTimer();
 }
 
-bool RotaryEncoder::changed(void)
+uint8_t RotaryEncoder::nextEvent(void)
 {
-    // returns one if the value changed since the last call of changed.
-    static int16_t prevValue = 0;
-    int16_t r = read();
-    if (r != prevValue)
+    uint8_t tail = eventTail;
+    if (tail == eventHead)
     {
-        prevValue = r;
-        return 1;
+        return ROTARY_EVENT_NONE;
     }
-    if (pushFlag == true)
+    uint8_t event = events[tail];
+    eventTail = (tail + 1) & (ROTARY_EVENT_QUEUE_SIZE - 1);
+
+    if (isTurn(event))
     {
-        return 1;
+        int16_t count = (maximum - minimum >= ROTARY_ACCELERATION_MIN_RANGE) ? (event & ROTARY_EVENT_STEPS_MASK) : 1;
+        int16_t s = ((event & ROTARY_EVENT_TYPE_MASK) == ROTARY_EVENT_CW) ? steps + count : steps - count;
+        // an accelerated turn stops at the end of the range, the next turn wraps around
+        if (s > maximum)
+            s = (steps == maximum) ? minimum : maximum;
+        else if (s < minimum)
+            s = (steps == minimum) ? maximum : minimum;
+        steps = s;
     }
-    return 0;
+    return event;
 }
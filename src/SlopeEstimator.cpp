@@ -0,0 +1,136 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#include "Brewpi.h"
+#include "TemperatureFormats.h"
+#include "SlopeEstimator.h"
+#include "FastDivide.h"
+
+// samples keep 4 fraction bits more than a regular temperature
+#define SLOPE_SAMPLE_SHIFT (TEMP_PRECISE_EXTRA_FRACTION_BITS - 4)
+// move the reference when a sample is more than 1 degree from it, so the samples in the window stay within 16 bits.
+#define SLOPE_SAMPLE_LIMIT (int32_t(TEMP_FIXED_POINT_SCALE) << 4)
+
+void SlopeEstimator::init(temperature_precise val)
+{
+	reference = val;
+	sum = 0;
+	weightedSum = 0;
+	count = 0;
+	next = 0;
+}
+
+bool SlopeEstimator::recenter(int32_t delta)
+{
+	// check that all samples still fit in 16 bits after moving the reference
+	// samples [0, count) are in use: the buffer fills from index 0 after init, and is entirely in use when full.
+	for (uint8_t i = 0; i < count; i++)
+	{
+		int32_t moved = samples[i] - delta;
+		if (moved > INT16_MAX || moved < INT16_MIN)
+		{
+			return false;
+		}
+	}
+	// subtracting delta from all samples changes sum by count*delta and weightedSum by delta * sum of the indexes
+	reference += delta << SLOPE_SAMPLE_SHIFT;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		samples[i] -= delta;
+	}
+	sum -= delta * count;
+	weightedSum -= delta * ((count * (count - 1)) / 2);
+	return true;
+}
+
+void SlopeEstimator::add(temperature_precise val)
+{
+	int32_t y = (val - reference) >> SLOPE_SAMPLE_SHIFT;
+	if (y > SLOPE_SAMPLE_LIMIT || y < -SLOPE_SAMPLE_LIMIT)
+	{
+		if (y > INT16_MAX || y < INT16_MIN || !recenter(y))
+		{
+			init(val); // jump is too large to keep the window within 16 bits, start over
+		}
+		y = (val - reference) >> SLOPE_SAMPLE_SHIFT;
+	}
+
+	if (count < SLOPE_WINDOW)
+	{
+		// window is filling up, the new sample gets index count
+		weightedSum += y * count;
+		sum += y;
+		count++;
+	}
+	else
+	{
+		// the oldest sample drops out and all other samples move down one index:
+		// weightedSum = weightedSum - (sum - oldest) + (SLOPE_WINDOW - 1) * y = weightedSum + SLOPE_WINDOW * y - newSum
+		sum += y - samples[next];
+		weightedSum += y * SLOPE_WINDOW - sum;
+	}
+	samples[next] = y;
+	next = (next + 1) & (SLOPE_WINDOW - 1);
+}
+
+temperature SlopeEstimator::readSlope(void)
+{
+	if (count < 2)
+	{
+		return 0;
+	}
+	int32_t n = count;
+	int32_t numerator = n * weightedSum - ((n * (n - 1)) / 2) * sum;
+#if SLOPE_WINDOW == 32
+	if (n == SLOPE_WINDOW)
+	{
+		// With a full window, which is every read after the first 32 seconds, the denominator is 87296 = 256 * 341.
+		// magnitude * 225 / 256 is split in the high and low byte so it fits 32 bits, then divided by 341 with a reciprocal.
+		uint32_t magnitude = (numerator < 0) ? 0u - uint32_t(numerator) : uint32_t(numerator);
+		uint32_t scaled = (magnitude >> 8) * 225 + ((uint16_t(magnitude & 0xFF) * 225) >> 8);
+		long_temperature slope = divideBy341(scaled);
+		return constrainTemp16((numerator < 0) ? -slope : slope);
+	}
+#endif
+	int32_t denominator = (n * n * (n * n - 1)) / 12;
+
+	// numerator / denominator is the slope per second in samples. Multiply by 3600 (1h) / 16 (sample fraction bits) = 225.
+	// The division is split in a quotient and remainder, so the multiplication cannot overflow.
+	int32_t quotient = numerator / denominator;
+	int32_t remainder = numerator % denominator;
+	if (quotient > MAX_TEMP / 225)
+	{
+		return MAX_TEMP;
+	}
+	if (quotient < MIN_TEMP / 225)
+	{
+		return MIN_TEMP;
+	}
+	return constrainTemp16(quotient * 225 + (remainder * 225) / denominator);
+}
@@ -36,7 +36,6 @@ license and credits. */
 #include "FastDigitalPin.h"
 #include "Pins.h"
 
-#include <util/delay.h>
 #include <util/atomic.h>
 
 #if BREWPI_SHIFT_LCD
@@ -46,7 +45,8 @@ license and credits. */
 // expand the SpiLcd class to a template, with a single int instantiation parameter.
 void SpiLcd::init()
 {
-    wait.millis(2000); // give LCD time to power up
+    queue.reset();
+    queue.holdOff(2000); // give LCD time to power up, the main loop keeps running meanwhile
 
     fastPinMode(lcdLatchPin, OUTPUT);
 
@@ -55,6 +55,8 @@ void SpiLcd::init()
     initSpi();
 
     _backlightTime = 0;
+    _resyncLine = 0;
+    _resyncCountdown = LCD_RESYNC_INTERVAL;
 }
 
 void SpiLcd::begin(uint8_t cols, uint8_t lines)
@@ -67,17 +69,13 @@ void SpiLcd::begin(uint8_t cols, uint8_t lines)
     // The following initialization sequence should be compatible with:
     // - Newhaven OLED displays
     // - Standard HD44780 or S6A0069 LCD displays
-    delayMicroseconds(50000); // wait 50 ms just to be sure that the lcd is initialized
-
-    write4bits(0x03);         //set to 8-bit
-    delayMicroseconds(50000); // wait > 4.1ms
-    write4bits(0x03);         //set to 8-bit
-    delayMicroseconds(1000);  // wait > 100us
-    write4bits(0x03);         //set to 8-bit
-    delayMicroseconds(50000); // wait for execution
-    write4bits(0x02);         //set to 4-bit
-    delayMicroseconds(50000); // wait for execution
-    command(0x28);            // set to 4-bit, 2-line
+    // The sequence and its delays are queued and sent by processQueue(), so it doesn't block the main loop.
+    enqueue(0x00, LCD_QUEUE_NOP | 50);    // wait 50 ms just to be sure that the lcd is initialized
+    enqueue(0x03, LCD_QUEUE_NIBBLE | 50); //set to 8-bit, wait > 4.1ms
+    enqueue(0x03, LCD_QUEUE_NIBBLE | 1);  //set to 8-bit, wait > 100us
+    enqueue(0x03, LCD_QUEUE_NIBBLE | 50); //set to 8-bit, wait for execution
+    enqueue(0x02, LCD_QUEUE_NIBBLE | 50); //set to 4-bit, wait for execution
+    command(0x28);                        // set to 4-bit, 2-line
 
     clear(); // display clear
     // Entry Mode Set:
@@ -93,7 +91,9 @@ void SpiLcd::begin(uint8_t cols, uint8_t lines)
 /********** high level commands, for the user! */
 void SpiLcd::clear()
 {
-    command(LCD_CLEARDISPLAY); // clear display, set cursor position to zero
+    enqueue(LCD_CLEARDISPLAY, LCD_CLEAR_DELAY); // clear display, set cursor position to zero
+    queue.clearChanged();
+    _contentVersion++;
 
     for (uint8_t i = 0; i < 4; i++)
     {
@@ -107,21 +107,20 @@ void SpiLcd::clear()
 
 void SpiLcd::home()
 {
-    command(LCD_RETURNHOME); // set cursor position to zero
+    enqueue(LCD_RETURNHOME, LCD_CLEAR_DELAY); // set cursor position to zero
     _currline = 0;
     _currpos = 0;
 }
 
+// The cursor is only moved on the display when a character that differs from the shadow copy is written, see write()
 void SpiLcd::setCursor(uint8_t col, uint8_t row)
 {
-    const uint8_t row_offsets[] = {0x00, 0x40, 0x14, 0x54};
     if (row >= _numlines)
     {
         row = 0; //write to first line if out off bounds
     }
     _currline = row;
     _currpos = col;
-    command(LCD_SETDDRAMADDR | (col + row_offsets[row]));
 }
 
 // Turn the display on/off (quickly)
@@ -206,7 +205,7 @@ void SpiLcd::createChar(uint8_t location, uint8_t charmap[])
     command(LCD_SETCGRAMADDR | (location << 3));
     for (int i = 0; i < 8; i++)
     {
-        write(charmap[i]);
+        enqueue(charmap[i], LCD_QUEUE_DATA | LCD_BYTE_DELAY); // CGRAM data, not part of the shadow copy
     }
 }
 
@@ -240,22 +239,117 @@ void SpiLcd::getLine(uint8_t lineNumber, char *buffer)
 
 inline void SpiLcd::command(uint8_t value)
 {
-    send(value, LOW);
-    waitBusy();
+    enqueue(value, LCD_BYTE_DELAY);
 }
 
+// Add a byte to the command queue. When the queue is full, wait until the display has taken the oldest one.
+void SpiLcd::enqueue(uint8_t value, uint8_t flags)
+{
+    while (!queue.push(value, flags))
+    {
+        processQueue();
+    }
+}
+
+// Only characters that differ from the shadow copy are marked to be sent by processQueue().
+// Characters beyond the end of the line are dropped, they would end up on another line of the display.
 inline size_t SpiLcd::write(uint8_t value)
 {
-    content[_currline][_currpos] = value;
-    _currpos++;
-    if (!_bufferOnly)
+    if (_currpos >= 20)
+    {
+        return 1;
+    }
+    char &cell = content[_currline][_currpos];
+    if (cell != char(value))
     {
-        send(value, HIGH);
-        waitBusy();
+        cell = value;
+        _contentVersion++;
+        queue.markChanged(_currline, _currpos);
     }
+    _currpos++;
     return 1;
 }
 
+// Called from the main loop. Sends at most one byte: queued commands first, then the changed characters of the shadow
+// copy in display order. The address command is only sent when the display cursor is not already at the right position,
+// so a run of changed characters costs a single address command.
+// Characters written in buffer only mode are kept until buffer only mode is turned off.
+void SpiLcd::processQueue(void)
+{
+    if (!queue.ready())
+    {
+        return;
+    }
+    uint8_t value, flags;
+    if (queue.pop(value, flags))
+    {
+        transmit(value, flags);
+        return;
+    }
+    uint8_t line, pos;
+    if (_bufferOnly || !queue.nextChanged(line, pos))
+    {
+        return;
+    }
+    static const uint8_t lineOffsets[] = {0x00, 0x40, 0x14, 0x54};
+    uint8_t address = lineOffsets[line] + pos;
+    if (address != queue.displayAddress())
+    {
+        transmit(LCD_SETDDRAMADDR | address, LCD_BYTE_DELAY);
+        return;
+    }
+    queue.markSent(line, pos);
+    transmit(content[line][pos], LCD_QUEUE_DATA | LCD_BYTE_DELAY);
+}
+
+// The display is write only, so corruption from noise on the cable cannot be detected. Instead, every
+// LCD_RESYNC_INTERVAL calls one line of the shadow copy is sent again, so a scrambled display is repaired within
+// 4 * LCD_RESYNC_INTERVAL calls without clearing it.
+// Before the first line, the interface is put back in 4 bit mode with the same nibbles as begin() and the display
+// settings are sent again. This recovers a display that lost track of which nibble comes next.
+// Nothing is added while commands are pending, e.g. during initialization, so the queue never has to wait.
+// Returns false, because corruption is never detected.
+bool SpiLcd::checkContent(void)
+{
+    if (_resyncCountdown > 1)
+    {
+        _resyncCountdown--;
+        return false;
+    }
+    if (queue.commandsPending())
+    {
+        return false; // tried again on the next call
+    }
+    _resyncCountdown = LCD_RESYNC_INTERVAL;
+    if (_resyncLine == 0)
+    {
+        enqueue(0x03, LCD_QUEUE_NIBBLE | LCD_BYTE_DELAY); //set to 8-bit, also completes a half received byte
+        enqueue(0x03, LCD_QUEUE_NIBBLE | LCD_BYTE_DELAY); //set to 8-bit
+        enqueue(0x03, LCD_QUEUE_NIBBLE | LCD_BYTE_DELAY); //set to 8-bit
+        enqueue(0x02, LCD_QUEUE_NIBBLE | LCD_BYTE_DELAY); //set to 4-bit
+        command(0x28);                                    // set to 4-bit, 2-line
+        command(LCD_ENTRYMODESET | _displaymode);
+        command(LCD_DISPLAYCONTROL | _displaycontrol);
+    }
+    queue.markLineChanged(_resyncLine);
+    _resyncLine = (_resyncLine + 1) & 3;
+    return false;
+}
+
+void SpiLcd::transmit(uint8_t value, uint8_t flags)
+{
+    if ((flags & LCD_QUEUE_NOP) == LCD_QUEUE_NIBBLE)
+    {
+        bitClear(_spiByte, LCD_SHIFT_RS); // initialization nibbles are commands
+        write4bits(value);
+    }
+    else if ((flags & LCD_QUEUE_NOP) != LCD_QUEUE_NOP)
+    {
+        send(value, flags & LCD_QUEUE_DATA);
+    }
+    queue.sent(value, flags, _displaymode == LCD_ENTRYLEFT);
+}
+
 /************ low level data pushing commands **********/
 void SpiLcd::initSpi(void)
 {
@@ -332,12 +426,6 @@ void SpiLcd::write4bits(uint8_t value)
     pulseEnable();
 }
 
-void SpiLcd::waitBusy(void)
-{
-    // we cannot read the busy pin, so just wait 1 ms
-    _delay_ms(1);
-}
-
 void SpiLcd::printSpacesToRestOfLine(void)
 {
     while (_currpos < 20)
@@ -39,6 +39,7 @@ license and credits. */
 #include "TempSensorDisconnected.h"
 #include "ModeControl.h"
 #include "fixstl.h"
+#include "Display.h"
 
 TempControl tempControl;
 
@@ -213,17 +214,17 @@ void TempControl::updatePID(void)
 		cv.p = multiplyFactorTemperatureDiff(cc.Kp, cv.beerDiff);
 		cv.i = multiplyFactorTemperatureDiffLong(cc.Ki, cv.diffIntegral);
 		cv.d = multiplyFactorTemperatureDiff(cc.Kd, cv.beerSlope);
-		long_temperature newFridgeSetting = cs.beerSetting;
-		newFridgeSetting += cv.p;
-		newFridgeSetting += cv.i;
-		newFridgeSetting += cv.d;
+		FixedLongTemperature newFridgeSetting = FixedTemperature::fromRaw(cs.beerSetting).convert<FixedLongTemperature>();
+		newFridgeSetting += FixedTemperature::fromRaw(cv.p).convert<FixedLongTemperature>();
+		newFridgeSetting += FixedTemperature::fromRaw(cv.i).convert<FixedLongTemperature>();
+		newFridgeSetting += FixedTemperature::fromRaw(cv.d).convert<FixedLongTemperature>();
 
 		// constrain to tempSettingMin or beerSetting - pidMAx, whichever is lower.
 		temperature lowerBound = (cs.beerSetting <= cc.tempSettingMin + cc.pidMax) ? cc.tempSettingMin : cs.beerSetting - cc.pidMax;
 		// constrain to tempSettingMax or beerSetting + pidMAx, whichever is higher.
 		temperature upperBound = (cs.beerSetting >= cc.tempSettingMax - cc.pidMax) ? cc.tempSettingMax : cs.beerSetting + cc.pidMax;
 
-		cs.fridgeSetting = constrain(constrainTemp16(newFridgeSetting), lowerBound, upperBound);
+		cs.fridgeSetting = constrain(constrainTemp16(newFridgeSetting.raw()), lowerBound, upperBound);
 	}
 	else if (cs.mode == MODE_FRIDGE_CONSTANT)
 	{
@@ -414,7 +415,7 @@ void TempControl::updateState(void)
 
 void TempControl::updateEstimatedPeak(uint16_t timeLimit, temperature estimator, uint16_t sinceIdle)
 {
-	uint16_t activeTime = min(timeLimit, sinceIdle);									// heat or cool time in seconds
+	uint16_t activeTime = min(timeLimit, sinceIdle); // heat or cool time in seconds
 	temperature estimatedOvershoot = ((long_temperature)estimator * activeTime) / 3600; // overshoot estimator is in overshoot per hour
 	if (stateIsCooling())
 	{
@@ -657,6 +658,7 @@ void TempControl::setMode(char newMode, bool force)
 			cs.fridgeSetting = DISABLED_TEMP;
 		}
 		eepromManager.storeTempSettings();
+		display.invalidate(LCD_FIELD_MODE | LCD_FIELD_BEER_SET | LCD_FIELD_FRIDGE_SET);
 	}
 }
 
@@ -698,6 +700,7 @@ void TempControl::setBeerTemp(temperature newTemp)
 {
 	temperature oldBeerSetting = cs.beerSetting;
 	cs.beerSetting = newTemp;
+	display.invalidate(LCD_FIELD_BEER_SET | LCD_FIELD_FRIDGE_SET); // the fridge setting follows the beer setting
 	if (abs(oldBeerSetting - newTemp) > intToTempDiff(1) / 2)
 	{			 // more than half degree C difference with old setting
 		reset(); // reset controller
@@ -717,6 +720,7 @@ void TempControl::setBeerTemp(temperature newTemp)
 void TempControl::setFridgeTemp(temperature newTemp)
 {
 	cs.fridgeSetting = newTemp;
+	display.invalidate(LCD_FIELD_FRIDGE_SET);
 	reset(); // reset peak detection and PID
 	updatePID();
 	updateState();
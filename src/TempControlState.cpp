@@ -0,0 +1,119 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#include "Brewpi.h"
+#include "TempControlState.h"
+#include "TempControl.h"
+#include "TempSensor.h"
+#include "OneWire.h"
+#include "PiLink.h"
+#include "Ticks.h"
+#include <stddef.h>
+
+#if BREWPI_WARM_RESTART
+
+struct TempControlSnapshot
+{
+	uint16_t magic;
+	control_mode_t mode;
+	bool doPosPeakDetect;
+	bool doNegPeakDetect;
+	// timers are stored as the time elapsed since the event, because the seconds counter restarts at 0 after a reset
+	tcduration_t sinceIdle;
+	tcduration_t sinceHeat;
+	tcduration_t sinceCool;
+	ControlVariables cv;
+	TempSensorState beer;
+	TempSensorState fridge;
+	uint8_t crc; // crc of all fields above
+};
+
+// the size is part of the magic word, so a snapshot left behind by firmware with a different layout is not used
+#define TEMP_CONTROL_SNAPSHOT_MAGIC uint16_t(0xB4E0 ^ sizeof(TempControlSnapshot))
+
+#if defined(ARDUINO)
+// RAM in the .noinit section is not cleared by the startup code, so it survives a reset (but not a power cycle)
+static TempControlSnapshot snapshot __attribute__((section(".noinit")));
+#else
+static TempControlSnapshot snapshot;
+#endif
+
+static uint8_t snapshotCrc()
+{
+	return OneWire::crc8((const uint8_t *)&snapshot, offsetof(TempControlSnapshot, crc));
+}
+
+void TempControlState::save(void)
+{
+	snapshot.magic = TEMP_CONTROL_SNAPSHOT_MAGIC;
+	snapshot.mode = tempControl.cs.mode;
+	snapshot.doPosPeakDetect = tempControl.doPosPeakDetect;
+	snapshot.doNegPeakDetect = tempControl.doNegPeakDetect;
+	snapshot.sinceIdle = tempControl.timeSinceIdle();
+	snapshot.sinceHeat = tempControl.timeSinceHeating();
+	snapshot.sinceCool = tempControl.timeSinceCooling();
+	snapshot.cv = tempControl.cv;
+	tempControl.beerSensor->saveState(snapshot.beer);
+	tempControl.fridgeSensor->saveState(snapshot.fridge);
+	snapshot.crc = snapshotCrc();
+}
+
+bool TempControlState::restore(void)
+{
+	if (snapshot.magic != TEMP_CONTROL_SNAPSHOT_MAGIC || snapshot.crc != snapshotCrc())
+	{
+		return false; // power-up, RAM content is random
+	}
+	snapshot.magic = 0; // only use a snapshot once, the next one is saved after the first control update
+
+	if (snapshot.mode != tempControl.cs.mode)
+	{
+		return false; // settings changed, the control variables do not apply anymore
+	}
+
+	// Control resumes from IDLE: an actuator that was on has been switched off by the reset.
+	// Because the timers are restored, the minimum off and switch times still count from before the reset.
+	ticks_seconds_t secs = ticks.seconds();
+	tempControl.lastIdleTime = secs - snapshot.sinceIdle;
+	tempControl.lastHeatTime = secs - snapshot.sinceHeat;
+	tempControl.lastCoolTime = secs - snapshot.sinceCool;
+	tempControl.doPosPeakDetect = snapshot.doPosPeakDetect;
+	tempControl.doNegPeakDetect = snapshot.doNegPeakDetect;
+	tempControl.cv = snapshot.cv;
+
+	bool beerRestored = tempControl.beerSensor->restoreState(snapshot.beer);
+	bool fridgeRestored = tempControl.fridgeSensor->restoreState(snapshot.fridge);
+	logDebug("warm restart: heat %u s, cool %u s ago, filters beer %d fridge %d",
+			 snapshot.sinceHeat, snapshot.sinceCool, beerRestored, fridgeRestored);
+	(void)beerRestored; // only used for logging
+	(void)fridgeRestored;
+	return true;
+}
+
+#endif
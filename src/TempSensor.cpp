@@ -45,6 +45,9 @@ void TempSensor::init()
             slowFilter.init(temp);
             slopeFilter.init(0);
             prevOutputForSlope = slowFilter.readOutputDoublePrecision();
+#if TEMP_SENSOR_SLOPE_REGRESSION
+            slopeEstimator.init(prevOutputForSlope);
+#endif
             failedReadCount = 0;
         }
     }
@@ -62,35 +65,73 @@ void TempSensor::update()
         return;
     }
 
-    fastFilter.add(temp);
-    slowFilter.add(temp);
+    // The filters expect a sample every second. Each failed read is a missed sample, which is filled in with this reading
+    // so that the filter delays and the slope scaling stay correct.
+    uint8_t samples = (failedReadCount < TEMP_SENSOR_MAX_CATCH_UP ? failedReadCount : TEMP_SENSOR_MAX_CATCH_UP) + 1;
+    failedReadCount = 0;
 
-    // update slope filter every 3 samples.
-    // averaged differences will give the slope. Use the slow filter as input
-    updateCounter--;
-    // initialize first read for slope filter after (255-4) seconds. This prevents an influence for the startup inaccuracy.
-    if (updateCounter == 4)
+    fastFilter.addN(temp, samples);
+
+#if TEMP_SENSOR_SLOPE_REGRESSION
+    if (slopeRegression)
     {
-        // only happens once after startup.
-        prevOutputForSlope = slowFilter.readOutputDoublePrecision();
+        // the regression needs the slow filter output of every sample, and does not need the warm-up below
+        while (samples--)
+        {
+            slowFilter.add(temp);
+            slopeEstimator.add(slowFilter.readOutputDoublePrecision());
+        }
+        return;
     }
-    if (updateCounter <= 0)
+#endif
+
+    // initialize first read for slope filter after (255-4) seconds. This prevents an influence for the startup inaccuracy.
+    if (updateCounter > 4)
     {
-        temperature_precise slowFilterOutput = slowFilter.readOutputDoublePrecision();
-        temperature_precise diff = slowFilterOutput - prevOutputForSlope;
-        temperature diff_upper = diff >> 16;
-        if (diff_upper > 27)
-        { // limit to prevent overflow INT_MAX/1200 = 27.14
-            diff = (27l << 16);
+        uint8_t count = (samples < updateCounter - 4) ? samples : updateCounter - 4;
+        slowFilter.addN(temp, count);
+        samples -= count;
+        updateCounter -= count;
+        if (updateCounter == 4)
+        {
+            // only happens once after startup.
+            prevOutputForSlope = slowFilter.readOutputDoublePrecision();
         }
-        else if (diff_upper < -27)
+        if (samples == 0)
         {
-            diff = (-27l << 16);
+            return;
         }
-        slopeFilter.addDoublePrecision(1200 * diff); // Multiply by 1200 (1h/4s), shift to single precision
-        prevOutputForSlope = slowFilterOutput;
-        updateCounter = 3;
     }
+
+    // update slope filter every 3 samples.
+    // averaged differences will give the slope. Use the slow filter as input
+    if (samples < updateCounter)
+    {
+        slowFilter.addN(temp, samples);
+        updateCounter -= samples;
+        return;
+    }
+    // The slow filter is advanced to the last sample at which the slope filter is due. When several updates are due after
+    // missed samples, the slope filter gets the average difference for each of them, so it is not stepped either.
+    uint8_t updates = 1 + (samples - updateCounter) / 3;
+    uint8_t toLastUpdate = updateCounter + 3 * (updates - 1);
+    slowFilter.addN(temp, toLastUpdate);
+    temperature_precise slowFilterOutput = slowFilter.readOutputDoublePrecision();
+    temperature_precise diff = (slowFilterOutput - prevOutputForSlope) / updates;
+    temperature diff_upper = diff >> 16;
+    if (diff_upper > 27)
+    { // limit to prevent overflow INT_MAX/1200 = 27.14
+        diff = (27l << 16);
+    }
+    else if (diff_upper < -27)
+    {
+        diff = (-27l << 16);
+    }
+    slopeFilter.addNDoublePrecision(1200 * diff, updates); // Multiply by 1200 (1h/4s), shift to single precision
+    prevOutputForSlope = slowFilterOutput;
+    samples -= toLastUpdate;
+    slowFilter.addN(temp, samples);
+    updateCounter = 3 - samples;
 }
 
 temperature TempSensor::readFastFiltered(void)
@@ -100,6 +141,12 @@ temperature TempSensor::readFastFiltered(void)
 
 temperature TempSensor::readSlope(void)
 {
+#if TEMP_SENSOR_SLOPE_REGRESSION
+    if (slopeRegression)
+    {
+        return slopeEstimator.readSlope();
+    }
+#endif
     // return slope per hour.
     temperature_precise doublePrecision = slopeFilter.readOutputDoublePrecision();
     return doublePrecision >> 16; // shift to single precision
@@ -130,6 +177,46 @@ void TempSensor::setSlopeFilterCoefficients(uint8_t b)
     slopeFilter.setCoefficients(b);
 }
 
+#if TEMP_SENSOR_SLOPE_REGRESSION
+void TempSensor::setSlopeRegression(bool enabled)
+{
+    slopeRegression = enabled;
+    slopeEstimator.init(slowFilter.readOutputDoublePrecision());
+}
+#endif
+
+#if BREWPI_WARM_RESTART
+void TempSensor::saveState(TempSensorState &state)
+{
+    state.fast = fastFilter.readOutput();
+    state.slow = slowFilter.readOutput();
+    state.slope = readSlope();
+}
+
+bool TempSensor::restoreState(const TempSensorState &state)
+{
+    if (failedReadCount != 0)
+    {
+        return false;
+    }
+    // do not resume from a snapshot that does not match the current reading, e.g. when the sensor was swapped
+    temperature diff = fastFilter.readOutput() - state.fast;
+    if (diff > TEMP_FIXED_POINT_SCALE || diff < -TEMP_FIXED_POINT_SCALE)
+    {
+        return false;
+    }
+    fastFilter.init(state.fast);
+    slowFilter.init(state.slow);
+    slopeFilter.init(state.slope);
+    prevOutputForSlope = slowFilter.readOutputDoublePrecision();
+    updateCounter = 3; // the slope filter is settled, skip the warm-up after startup
+#if TEMP_SENSOR_SLOPE_REGRESSION
+    slopeEstimator.init(prevOutputForSlope);
+#endif
+    return true;
+}
+#endif
+
 BasicTempSensor &TempSensor::sensor()
 {
     return *_sensor;
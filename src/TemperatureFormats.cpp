@@ -31,8 +31,8 @@ license and credits. */
 #include "TemperatureFormats.h"
 #include "Platform.h"
 #include "TempControl.h"
+#include "FastDivide.h"
 #include <string.h>
-#include <stdarg.h>
 
 // See header file for details about the temp format used.
 
@@ -63,16 +63,38 @@ char *fixedPointToString(char *s, temperature rawValue, uint8_t numDecimals, uin
     return fixedPointToString(s, long_temperature(rawValue), numDecimals, maxLength);
 }
 
-// this gets rid of snprintf_P
+static const uint16_t powersOf10[] PROGMEM = {10000, 1000, 100, 10, 1};
 
-void mysnprintf_P(char *buf, int len, const char *fmt, ...)
+// Writes value in decimal to s, with at least minDigits digits (zero padded), but never past end.
+// Digits are extracted by repeated subtraction instead of division, because AVR has no divide instruction.
+// Returns a pointer to the position after the last digit written.
+static char *appendDecimal(char *s, const char *end, uint16_t value, uint8_t minDigits)
 {
-    va_list args;
-    va_start(args, fmt);
-    vsnprintf_P(buf, len, fmt, args);
-    va_end(args);
+    bool leadingZero = true;
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        uint16_t power = pgm_read_word(&powersOf10[i]);
+        char digit = '0';
+        while (value >= power)
+        {
+            value -= power;
+            digit++;
+        }
+        if (leadingZero && digit == '0' && uint8_t(5 - i) > minDigits)
+        {
+            continue; // skip leading zero
+        }
+        leadingZero = false;
+        if (s < end)
+        {
+            *s++ = digit;
+        }
+    }
+    return s;
 }
 
+// Writes the sign in s[0] (space or minus) and the value with numDecimals decimals after it, like "%d.%0Nd".
+// At most maxLength - 2 characters are written after the sign, followed by a terminating zero.
 char *fixedPointToString(char *s, long_temperature rawValue, uint8_t numDecimals, uint8_t maxLength)
 {
     s[0] = ' ';
@@ -81,22 +103,19 @@ char *fixedPointToString(char *s, long_temperature rawValue, uint8_t numDecimals
         s[0] = '-';
         rawValue = -rawValue;
     }
-    int intPart = rawValue >> TEMP_FIXED_POINT_BITS; // do not use longTempDiffToInt because it rounds up
+    uint16_t intPart = rawValue >> TEMP_FIXED_POINT_BITS; // rounded down, the fraction is formatted separately
     uint16_t fracPart;
-    const char *fmt;
     uint16_t scale;
     switch (numDecimals)
     {
     case 1:
-        fmt = PSTR("%d.%01d");
         scale = 10;
         break;
     case 2:
-        fmt = PSTR("%d.%02d");
         scale = 100;
         break;
     default:
-        fmt = PSTR("%d.%03d");
+        numDecimals = 3;
         scale = 1000;
     }
     fracPart = ((rawValue & TEMP_FIXED_POINT_MASK) * scale + TEMP_FIXED_POINT_SCALE / 2) >> TEMP_FIXED_POINT_BITS; // add 256 for rounding
@@ -105,10 +124,111 @@ char *fixedPointToString(char *s, long_temperature rawValue, uint8_t numDecimals
         intPart++;
         fracPart = 0;
     }
-    mysnprintf_P(&s[1], maxLength - 1, fmt, intPart, fracPart);
+    const char *end = s + maxLength - 1;
+    char *p = appendDecimal(&s[1], end, intPart, 1);
+    if (p < end)
+    {
+        *p++ = '.';
+    }
+    p = appendDecimal(p, end, fracPart, numDecimals);
+    *p = '\0';
     return s;
 }
 
+// Number of decimals that are used when parsing a fixed point value. Further decimals are ignored.
+// With 5 decimals (units of 0.00001), the scaling to fixed point reduces to small constants that cannot overflow 32 bits.
+#define PARSE_DECIMALS 5
+#define PARSE_UNIT 100000l
+
+/*
+ * Parses a decimal number and converts it to fixed point in a single scan.
+ * The number is read as an integer in units of 0.00001, and scaled to fixed point with a single rounded division:
+ *   Celsius:    value * 512 / 100000 = value * 16 / 3125
+ *   Fahrenheit: value * 5/9 * 512 / 100000 = value * 16 / 5625
+ * Both divisors are odd, so there are no ties and the result is the nearest fixed point value.
+ * With addOffset, the result is a temperature: for Fahrenheit, 32F is subtracted first, and C_OFFSET is added to the result.
+ * The integer part saturates at 1000, which is out of range for all users.
+ * Accepts leading spaces, an optional plus or minus sign, digits, and optionally a decimal point with decimals.
+ * The number must be followed by the end of the string or a space.
+ */
+static bool parseFixedPoint(long_temperature *result, const char *s, char format, bool addOffset)
+{
+    while (*s == ' ')
+    {
+        s++;
+    }
+    bool negative = (*s == '-');
+    if (negative || *s == '+')
+    {
+        s++;
+    }
+    uint16_t intPart = 0;
+    uint8_t intDigits = 0;
+    uint8_t digit;
+    while ((digit = uint8_t(*s - '0')) <= 9)
+    {
+        intPart = intPart * 10 + digit;
+        if (intPart > 1000)
+        {
+            intPart = 1000; // saturate
+        }
+        intDigits++;
+        s++;
+    }
+    if (intDigits == 0)
+    {
+        return false; // no number found in string
+    }
+    uint32_t fraction = 0;
+    uint8_t decimals = 0;
+    if (*s == '.')
+    {
+        s++;
+        while ((digit = uint8_t(*s - '0')) <= 9)
+        {
+            if (decimals < PARSE_DECIMALS)
+            {
+                fraction = fraction * 10 + digit;
+                decimals++;
+            }
+            s++;
+        }
+    }
+    if (*s != '\0' && *s != ' ')
+    {
+        return false; // parsing did not end at end of string or space
+    }
+    for (; decimals < PARSE_DECIMALS; decimals++)
+    {
+        fraction *= 10;
+    }
+
+    int32_t value = int32_t(intPart) * PARSE_UNIT + fraction;
+    if (negative)
+    {
+        value = -value;
+    }
+    int16_t divisor = 3125;
+    if (format == 'F')
+    {
+        if (addOffset)
+        {
+            value -= 32 * PARSE_UNIT;
+        }
+        divisor = 5625;
+    }
+    value *= 16;
+    // round half away from zero
+    int16_t half = divisor / 2;
+    long_temperature fixed = (value + (value < 0 ? -half : half)) / divisor;
+    if (addOffset)
+    {
+        fixed += C_OFFSET;
+    }
+    *result = fixed;
+    return true;
+}
+
 bool stringToTemp(temperature *result, const char *numberString)
 {
     if (0 == strcmp(PSTR("null"), numberString))
@@ -117,9 +237,9 @@ bool stringToTemp(temperature *result, const char *numberString)
         return true;
     }
     long_temperature longResult;
-    if (stringToFixedPoint(&longResult, numberString))
+    if (parseFixedPoint(&longResult, numberString, tempControl.cc.tempFormat, true))
     {
-        *result = constrainTemp16(convertToInternalTemp(longResult));
+        *result = constrainTemp16(longResult);
         return true;
     }
     return false;
@@ -128,9 +248,8 @@ bool stringToTemp(temperature *result, const char *numberString)
 bool stringToTempDiff(temperature *result, const char *numberString)
 {
     long_temperature longResult;
-    if (stringToFixedPoint(&longResult, numberString))
+    if (parseFixedPoint(&longResult, numberString, tempControl.cc.tempFormat, false))
     {
-        longResult = convertToInternalTempDiff(longResult);
         *result = constrainTemp16(longResult);
         return true;
     }
@@ -145,40 +264,8 @@ bool invalidStrtolResult(const char *start, const char *end)
 
 bool stringToFixedPoint(long_temperature *result, const char *numberString)
 {
-    // receive new temperature as null terminated string: "19.20"
-    long_temperature newValue;
-    long_temperature decimalValue = 0;
-    char *decimalPtr;
-    char *end;
-    // Check if - is in the string
-    bool positive = (0 == strchr(numberString, '-'));
-
-    newValue = strtol_impl(numberString, &end); // convert string to integer
-    if (invalidStrtolResult(numberString, end))
-    {
-        return false; // string was not valid
-    }
-    newValue = newValue << TEMP_FIXED_POINT_BITS; // shift to fixed point
-
-    // find the point in the string to know whether we have decimals
-    decimalPtr = strchr(numberString, '.'); // returns pointer to the point.
-    if (decimalPtr != 0)
-    {
-        decimalPtr++; // skip decimal point
-        // convert decimals to integer
-        decimalValue = strtol_impl(decimalPtr, &end) << TEMP_FIXED_POINT_BITS;
-        if (invalidStrtolResult(decimalPtr, end))
-        {
-            return false; // string was not valid
-        }
-        uint8_t charsAfterPoint = end - decimalPtr; // actually used # digits after point
-        while (charsAfterPoint-- > 0)
-        {
-            decimalValue = (decimalValue + 5) / 10;
-        }
-    }
-    *result = positive ? newValue + decimalValue : newValue - decimalValue;
-    return true;
+    // receive new value as null terminated string: "19.20"
+    return parseFixedPoint(result, numberString, 'C', false);
 }
 
 bool stringToFixedPoint(temperature *result, const char *numberString)
@@ -256,8 +343,10 @@ long_temperature convertToInternalTempImpl(long_temperature rawTemp, bool addOff
         {
             rawTemp = rawTemp - (temperature(32) << TEMP_FIXED_POINT_BITS);
         }
-        int8_t rounder = (rawTemp < 0) ? -45 : 45;
-        rawTemp = (rawTemp * 50 + rounder) / 90; // rounded result
+        // (rawTemp * 50 + 45) / 90 == ((rawTemp * 10 + 9) / 2) / 9, rounded away from zero on the magnitude
+        uint32_t magnitude = (rawTemp < 0) ? -rawTemp : rawTemp;
+        magnitude = divideBy9((magnitude * 10 + 9) >> 1);
+        rawTemp = (rawTemp < 0) ? -long_temperature(magnitude) : long_temperature(magnitude);
     }
     if (addOffset)
     {
@@ -274,10 +363,17 @@ long_temperature convertFromInternalTempImpl(long_temperature rawTemp, bool addO
     { // value received is in F, convert to C
         if (addOffset)
         {
-            rawTemp -= F_OFFSET;
+            rawTemp -= C_OFFSET;
+        }
+        // (rawTemp * 90 + 25) / 50 == (rawTemp * 18 + 5) / 10, rounded away from zero on the magnitude
+        uint32_t magnitude = (rawTemp < 0) ? -rawTemp : rawTemp;
+        magnitude = (magnitude * 18 + 5) / 10;
+        rawTemp = (rawTemp < 0) ? -long_temperature(magnitude) : long_temperature(magnitude);
+        if (addOffset)
+        {
+            // add 32F after rounding, F_OFFSET is not an integer number of steps
+            rawTemp += long_temperature(32) << TEMP_FIXED_POINT_BITS;
         }
-        int8_t rounder = (rawTemp < 0) ? -25 : 25;
-        rawTemp = (rawTemp * 90 + rounder) / 50; // round result
     }
     else if (addOffset)
     {
@@ -286,17 +382,52 @@ long_temperature convertFromInternalTempImpl(long_temperature rawTemp, bool addO
     return rawTemp;
 }
 
+// Tenths are calculated from the internal format in one rounding step, rounding twice can be off by one.
 int fixedToTenths(long_temperature temp)
 {
-    temp = convertFromInternalTemp(temp);
-    temperature rounder = (temp < 0) ? -TEMP_FIXED_POINT_SCALE / 2 : TEMP_FIXED_POINT_SCALE / 2;
-    return (10 * temp + rounder) / TEMP_FIXED_POINT_SCALE; // return rounded result in tenth of degrees
+    long_temperature scaled = temp - C_OFFSET;
+    if (tempControl.cc.tempFormat == 'F')
+    {
+        scaled = scaled * 18 + (long_temperature(320) << TEMP_FIXED_POINT_BITS); // 10 * 9/5, and 32F in tenths
+    }
+    else
+    {
+        scaled = scaled * 10;
+    }
+    temperature rounder = (scaled < 0) ? -TEMP_FIXED_POINT_SCALE / 2 : TEMP_FIXED_POINT_SCALE / 2;
+    return (scaled + rounder) / TEMP_FIXED_POINT_SCALE; // return rounded result in tenth of degrees
+}
+
+// Rounds like fixedPointToString() with 1 decimal, after the same conversion as tempToString(). This differs from
+// fixedToTenths(), which rounds the internal value in a single step. Returns the magnitude in tenths of the display unit,
+// or its one's complement for a negative value, because "-0.0" and " 0.0" are different text.
+int16_t tempToShownTenths(long_temperature temp)
+{
+    long_temperature rawValue = convertFromInternalTemp(temp);
+    bool negative = rawValue < 0;
+    if (negative)
+    {
+        rawValue = -rawValue;
+    }
+    uint16_t intPart = rawValue >> TEMP_FIXED_POINT_BITS;
+    uint16_t fracPart = ((rawValue & TEMP_FIXED_POINT_MASK) * 10 + TEMP_FIXED_POINT_SCALE / 2) >> TEMP_FIXED_POINT_BITS;
+    int16_t tenths = intPart * 10 + fracPart; // a fraction rounded up to 10 carries into the integer part
+    return negative ? ~tenths : tenths;
 }
 
 temperature tenthsToFixed(int temp)
 {
-    long_temperature fixedPointTemp = convertToInternalTemp(((long_temperature)temp * TEMP_FIXED_POINT_SCALE + 5) / 10);
-    return constrainTemp16(fixedPointTemp);
+    // tenths * 512 / 10 = tenths * 256 / 5 for C, and (tenths - 320) * 5/9 * 512 / 10 = (tenths - 320) * 256 / 9 for F
+    long_temperature scaled = temp;
+    int8_t divisor = 5;
+    if (tempControl.cc.tempFormat == 'F')
+    {
+        scaled -= 320;
+        divisor = 9;
+    }
+    scaled *= 256;
+    int8_t rounder = (scaled < 0) ? -divisor / 2 : divisor / 2; // divisors are odd, so there are no ties
+    return constrainTemp16((scaled + rounder) / divisor + C_OFFSET);
 }
 
 temperature constrainTemp(long_temperature valLong, temperature lower, temperature upper)
@@ -315,35 +446,28 @@ temperature constrainTemp(long_temperature valLong, temperature lower, temperatu
 
 temperature constrainTemp16(long_temperature val)
 {
-    if (val < MIN_TEMP)
-    {
-        return MIN_TEMP;
-    }
-    if (val > MAX_TEMP)
-    {
-        return MAX_TEMP;
-    }
-    return val;
+    return FixedLongTemperature::fromRaw(val).saturate<FixedTemperature>().raw();
 }
 
 temperature multiplyFactorTemperatureLong(temperature factor, long_temperature b)
 {
-    return constrainTemp16(((long_temperature)factor * (b - C_OFFSET)) >> TEMP_FIXED_POINT_BITS);
+    return multiplyFactorTemperatureDiffLong(factor, b - C_OFFSET);
 }
 
 temperature multiplyFactorTemperatureDiffLong(temperature factor, long_temperature b)
 {
-    return constrainTemp16(((long_temperature)factor * b) >> TEMP_FIXED_POINT_BITS);
+    // the product is limited by constrainTemp16, which is not inlined to keep the code small
+    return constrainTemp16(FixedTemperature::fromRaw(factor).multiply<FixedLongTemperature>(FixedLongTemperature::fromRaw(b)).raw());
 }
 
 temperature multiplyFactorTemperature(temperature factor, temperature b)
 {
-    return constrainTemp16(((long_temperature)factor * ((long_temperature)b - C_OFFSET)) >> TEMP_FIXED_POINT_BITS);
+    return multiplyFactorTemperatureDiffLong(factor, long_temperature(b) - C_OFFSET);
 }
 
 temperature multiplyFactorTemperatureDiff(temperature factor, temperature b)
 {
-    return constrainTemp16(((long_temperature)factor * (long_temperature)b) >> TEMP_FIXED_POINT_BITS);
+    return constrainTemp16(FixedTemperature::fromRaw(factor).multiply<FixedLongTemperature>(FixedTemperature::fromRaw(b)).raw());
 }
 
 long int my_strtol(const char *str, char **tail)
@@ -38,7 +38,7 @@ ticks_seconds_t HardwareTicks::timeSince(ticks_seconds_t previousTime)
     return ::timeSince(currentTime, previousTime);
 }
 
-ticks_seconds_t HardwareTicks::seconds() { return ::millis() / 1000; }
+ticks_seconds_t HardwareTicks::seconds() { return divideBy1000(::millis()); }
 
 void HardwareDelay::millis(uint16_t millis) { ::delay(millis); }
 
@@ -42,7 +42,7 @@ uint8_t UI::init()
 {
 #if BREWPI_BUZZER
 	buzzer.init();
-	buzzer.beep(2, 500);
+	buzzer.play(BUZZER_STARTUP);
 #endif
 	display.init();
 	rotaryEncoder.init();
@@ -66,15 +66,29 @@ void UI::showControllerPage()
 extern ValueActuator alarm;
 void UI::ticks()
 {
+	display.processQueue();
+
 #if BREWPI_BUZZER
-	buzzer.setActive(alarm.isActive() && !buzzer.isActive());
+	if (alarm.isActive() && !buzzer.isPlaying())
+	{
+		buzzer.play(BUZZER_ALARM);
+	}
+	buzzer.update();
 #endif
 
 #if BREWPI_MENU
-	if (rotaryEncoder.pushed())
+	if (menu.isActive())
+	{
+		menu.update();
+	}
+	else
 	{
-		rotaryEncoder.resetPushed();
-		menu.pickSettingToChange();
+		// turning the encoder only turns on the backlight, a push opens the menu
+		uint8_t event = rotaryEncoder.nextEvent();
+		if (event == ROTARY_EVENT_PUSH || event == ROTARY_EVENT_LONG_PRESS)
+		{
+			menu.pickSettingToChange();
+		}
 	}
 #endif
 }
@@ -84,9 +98,15 @@ void UI::update()
 
 	// update the lcd for the chamber being displayed
 	display.printState();
-	display.printAllTemperatures();
-	display.printMode();
+#if BREWPI_MENU
+	if (!menu.isActive()) // the menu shows the mode and settings that are being changed
+#endif
+	{
+		display.printAllTemperatures();
+		display.printMode();
+	}
 	display.updateBacklight();
+	display.checkContent();
 }
 
 bool UI::inStartup() { return false; }
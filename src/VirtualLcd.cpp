@@ -0,0 +1,143 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+#include "Brewpi.h"
+#include "VirtualLcd.h"
+
+#if BREWPI_VIRTUAL_LCD
+
+#include <string.h>
+
+void VirtualLcd::init()
+{
+	resetStats();
+}
+
+void VirtualLcd::begin(uint8_t cols, uint8_t lines)
+{
+	_numlines = lines;
+	clear();
+	home();
+}
+
+void VirtualLcd::clear()
+{
+	NullLcdDriver::clear();
+	current.commands++;
+}
+
+void VirtualLcd::home()
+{
+	NullLcdDriver::home();
+	current.commands++;
+}
+
+void VirtualLcd::setCursor(uint8_t col, uint8_t row)
+{
+	NullLcdDriver::setCursor(col, row);
+	current.commands++;
+}
+
+// Characters beyond the end of the line are dropped, like on the hardware drivers
+size_t VirtualLcd::write(uint8_t value)
+{
+	if (_currpos >= 20)
+	{
+		return 1;
+	}
+	current.chars++;
+	char &cell = content[_currline][_currpos];
+	if (cell != char(value))
+	{
+		cell = value;
+		current.changed++;
+		_contentVersion++;
+	}
+	_currpos++;
+	return 1;
+}
+
+void VirtualLcd::processQueue(void)
+{
+	if (current.chars == 0 && current.commands == 0)
+	{
+		return;
+	}
+	current.time = ticks.millis();
+	memcpy(current.content, content, sizeof(content));
+	totals.frames++;
+	totals.chars += current.chars;
+	totals.changed += current.changed;
+	totals.commands += current.commands;
+	if (frameFile)
+	{
+		printFrame(frameFile, current);
+		fflush(frameFile);
+	}
+
+	frames[nextFrame] = current;
+	nextFrame = (nextFrame + 1) % VIRTUAL_LCD_FRAMES;
+	if (numFrames < VIRTUAL_LCD_FRAMES)
+	{
+		numFrames++;
+	}
+	current.chars = 0;
+	current.changed = 0;
+	current.commands = 0;
+}
+
+const VirtualLcdFrame &VirtualLcd::frame(uint8_t index) const
+{
+	uint8_t oldest = (nextFrame + VIRTUAL_LCD_FRAMES - numFrames) % VIRTUAL_LCD_FRAMES;
+	return frames[(oldest + index) % VIRTUAL_LCD_FRAMES];
+}
+
+// Clears the frame log and the counters
+void VirtualLcd::resetStats(void)
+{
+	nextFrame = 0;
+	numFrames = 0;
+	memset(&current, 0, sizeof(current));
+	memset(&totals, 0, sizeof(totals));
+}
+
+// Writes a frame as a header line and the 4 lines of the display between bars:
+// frame t=12000 chars=16 changed=2 commands=2
+// |Mode   Beer Const.  |
+void VirtualLcd::printFrame(FILE *file, const VirtualLcdFrame &frame)
+{
+	fprintf(file, "frame t=%lu chars=%u changed=%u commands=%u\n",
+			(unsigned long)frame.time, frame.chars, frame.changed, frame.commands);
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		fprintf(file, "|%s|\n", frame.content[i]);
+	}
+}
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * Minimal stand-in for the Arduino core, used by the native test environment.
+ * It provides the declarations the firmware sources under test need on the host, and nothing more.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <avr/pgmspace.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define _BV(bit) (1 << (bit))
+
+#ifndef min
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#endif
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+
+// Simulated time. Only the delays advance it, so a test decides how much time passes between calls.
+inline unsigned long &hostMicros()
+{
+    static unsigned long now = 0;
+    return now;
+}
+
+inline unsigned long micros() { return hostMicros(); }
+inline unsigned long millis() { return hostMicros() / 1000; }
+inline void delay(unsigned long ms) { hostMicros() += ms * 1000; }
+inline void delayMicroseconds(unsigned int us) { hostMicros() += us; }
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+
+#define MOSI 11
+#define MISO 12
+#define SCK 13
+#define SS 10
+
+// SPI registers of the ATmega328P. A transfer completes immediately, the bytes written to SPDR are passed to
+// hostSpiByteSent, which a test can point at a function that counts or decodes them.
+#define SPR0 0
+#define SPR1 1
+#define CPHA 2
+#define CPOL 3
+#define MSTR 4
+#define DORD 5
+#define SPE 6
+#define SPIF 7
+
+inline void (*&hostSpiByteSent())(uint8_t)
+{
+    static void (*callback)(uint8_t) = 0;
+    return callback;
+}
+
+struct HostSpiDataRegister
+{
+    HostSpiDataRegister &operator=(uint8_t value)
+    {
+        if (hostSpiByteSent())
+        {
+            hostSpiByteSent()(value);
+        }
+        return *this;
+    }
+};
+
+inline HostSpiDataRegister &hostSpdr()
+{
+    static HostSpiDataRegister spdr;
+    return spdr;
+}
+
+inline uint8_t &hostSpcr()
+{
+    static uint8_t spcr = 0;
+    return spcr;
+}
+
+inline uint8_t &hostSpsr()
+{
+    static uint8_t spsr = _BV(SPIF);
+    return spsr;
+}
+
+#define SPDR hostSpdr()
+#define SPCR hostSpcr()
+#define SPSR hostSpsr()
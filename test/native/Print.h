@@ -0,0 +1,30 @@
+/*
+ * The part of the Arduino Print class that the display drivers use, for the native test environment.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class Print
+{
+  public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t) = 0;
+
+    size_t write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size--)
+        {
+            n += write(*buffer++);
+        }
+        return n;
+    }
+
+    size_t print(const char *str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+};
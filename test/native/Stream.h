@@ -0,0 +1,16 @@
+/*
+ * The declaration of the Arduino Stream class, for the native test environment. Headers that declare functions
+ * taking a Stream compile with it, the tests do not call them.
+ */
+
+#pragma once
+
+#include <Print.h>
+
+class Stream : public Print
+{
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
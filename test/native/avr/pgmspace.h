@@ -0,0 +1,37 @@
+/*
+ * Program memory access for the native test environment. On the host, flash and RAM are the same address space.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strcmp_P strcmp
+#define strlen_P strlen
+#define vsnprintf_P vsnprintf
+#define snprintf_P snprintf
+#define sprintf_P sprintf
+
+inline size_t strlcpy_P(char *dst, const char *src, size_t size)
+{
+    size_t length = strlen(src);
+    if (size)
+    {
+        size_t n = length < size - 1 ? length : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return length;
+}
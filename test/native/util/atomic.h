@@ -0,0 +1,9 @@
+/*
+ * Interrupt blocks for the native test environment. The host has no interrupts, so the block runs once.
+ */
+
+#pragma once
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) for (bool atomicOnce = true; atomicOnce; atomicOnce = false)
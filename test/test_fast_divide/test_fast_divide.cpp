@@ -0,0 +1,101 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/*
+ * Checks every function in FastDivide.h against the division it replaces, for every input in its documented range.
+ * Run with: pio test -e native -f test_fast_divide
+ */
+
+#include <unity.h>
+#include <stdio.h>
+
+#include "FastDivide.h"
+
+// Compares fast(n) with n / divisor for all n in [0, end). Returns the number of mismatches, and reports the first.
+template <typename Fn>
+static uint32_t checkRange(const char *name, Fn fast, uint32_t divisor, uint64_t end)
+{
+    uint32_t mismatches = 0;
+    for (uint64_t i = 0; i < end; i++)
+    {
+        uint32_t n = uint32_t(i);
+        if (fast(n) != n / divisor)
+        {
+            if (mismatches == 0)
+            {
+                char msg[80];
+                snprintf(msg, sizeof(msg), "%s(%lu) = %lu, expected %lu", name, (unsigned long)n, (unsigned long)fast(n), (unsigned long)(n / divisor));
+                TEST_MESSAGE(msg);
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+static const uint64_t ALL_32_BIT = 1ull << 32;
+static const uint64_t BELOW_2_31 = 1ull << 31;
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_divide_by_9(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(0, checkRange("divideBy9", divideBy9, 9, ALL_32_BIT));
+}
+
+void test_divide_by_1000(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(0, checkRange("divideBy1000", divideBy1000, 1000, ALL_32_BIT));
+}
+
+void test_divide_by_341(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(0, checkRange("divideBy341", divideBy341, 341, BELOW_2_31));
+}
+
+void test_divide_by_60(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(0, checkRange("divideBy60", [](uint32_t n) { return uint32_t(divideBy60(uint16_t(n))); }, 60, 1ul << 16));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_divide_by_9);
+    RUN_TEST(test_divide_by_1000);
+    RUN_TEST(test_divide_by_341);
+    RUN_TEST(test_divide_by_60);
+    return UNITY_END();
+}
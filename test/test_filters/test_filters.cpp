@@ -0,0 +1,367 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/*
+ * Tests for the cascaded filter with shared section history: a memory report, and a check that its output is bit
+ * identical to the original layout of NUM_SECTIONS separate FixedFilter sections. Also compares the closed form catch-up
+ * of addN() with separate adds, and the slope of the least squares estimator with the slope filter on a noisy ramp.
+ * Run with: pio test -e native -f test_filters -v
+ */
+
+// the regression slope estimator is off by default, it is compiled in to compare it with the slope filter
+#define TEMP_SENSOR_SLOPE_REGRESSION 1
+
+#include <unity.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+
+#include "Brewpi.h"
+#include "TicksImpl.h" // before Ticks.h, which needs NoOpDelay from it when ARDUINO is not defined
+#include "Stream.h"    // comes with the Arduino core, PiLink.h needs it through TempSensor.cpp
+#include "FilterFixed.h"
+#include "FilterCascaded.h"
+#include "TempSensor.h"
+
+// the native environment does not build src, the sources under test are compiled with the test
+#include "../../src/FilterFixed.cpp"
+#include "../../src/FilterCascaded.cpp"
+#include "../../src/SlopeEstimator.cpp"
+#include "../../src/TempSensor.cpp"
+#include "../../src/TemperatureFormats.cpp"
+
+ControlConstants TempControl::cc;
+
+// the Arduino stand-in defines min and max as macros, which hide std::max
+#undef min
+#undef max
+
+// The original CascadedFilter: each section is a complete FixedFilter with its own input and output history.
+class SectionCascadedFilter
+{
+  public:
+    FixedFilter sections[NUM_SECTIONS];
+
+    void setCoefficients(uint8_t bValue)
+    {
+        for (FixedFilter &s : sections)
+        {
+            s.setCoefficients(bValue);
+        }
+    }
+
+    void init(temperature val)
+    {
+        for (FixedFilter &s : sections)
+        {
+            s.init(val);
+        }
+    }
+
+    temperature_precise addDoublePrecision(temperature_precise val)
+    {
+        for (FixedFilter &s : sections)
+        {
+            val = s.addDoublePrecision(val);
+        }
+        return val;
+    }
+};
+
+// filter state in bytes on AVR, which does not pad: the history and the coefficients
+static size_t stateBytes(const FixedFilter &f)
+{
+    return sizeof(f.xv) + sizeof(f.yv) + sizeof(f.a) + sizeof(f.b);
+}
+
+static size_t stateBytes(const CascadedFilter &f)
+{
+    return sizeof(f.history) + sizeof(f.a) + sizeof(f.b);
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_memory(void)
+{
+    CascadedFilter shared;
+    size_t sectioned = NUM_SECTIONS * stateBytes(FixedFilter());
+    char msg[120];
+    snprintf(msg, sizeof(msg), "CascadedFilter state: %u bytes, was %u with separate sections. Per TempSensor (3 filters): %u, was %u",
+             unsigned(stateBytes(shared)), unsigned(sectioned), unsigned(3 * stateBytes(shared)), unsigned(3 * sectioned));
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_EQUAL((NUM_SECTIONS + 1) * 3 * sizeof(temperature_precise) + 2, stateBytes(shared));
+    TEST_ASSERT_LESS_THAN(sectioned, stateBytes(shared));
+}
+
+// Feeds both filters a random walk with occasional steps, for every b value that can be set, and compares the outputs,
+// the inputs and the peak detection after every sample.
+void test_matches_separate_sections(void)
+{
+    srand(1);
+    for (uint8_t b = 0; b <= 6; b++)
+    {
+        CascadedFilter shared;
+        SectionCascadedFilter sectioned;
+        shared.setCoefficients(b);
+        sectioned.setCoefficients(b);
+        temperature val = intToTemp(20);
+        shared.init(val);
+        sectioned.init(val);
+        FixedFilter &last = sectioned.sections[NUM_SECTIONS - 1];
+        for (uint16_t i = 0; i < 20000; i++)
+        {
+            if (i % 2500 == 0)
+            {
+                val = intToTemp(rand() % 60 - 10); // step to a new temperature
+            }
+            val += rand() % 33 - 16; // the steps stay well away from the limits of the temperature range
+            temperature_precise precise = tempRegularToPrecise(val);
+            TEST_ASSERT_EQUAL_INT32(sectioned.addDoublePrecision(precise), shared.addDoublePrecision(precise));
+            TEST_ASSERT_EQUAL_INT32(last.readPrevOutputDoublePrecision(), shared.readPrevOutputDoublePrecision());
+            TEST_ASSERT_EQUAL_INT16(sectioned.sections[0].readInput(), shared.readInput());
+            TEST_ASSERT_EQUAL_INT16(last.detectPosPeak(), shared.detectPosPeak());
+            TEST_ASSERT_EQUAL_INT16(last.detectNegPeak(), shared.detectNegPeak());
+        }
+    }
+}
+
+// largest difference between two filter histories, in units of the double precision format
+template <class Filter>
+static temperature_precise historyDifference(const Filter &a, const Filter &b);
+
+template <>
+temperature_precise historyDifference(const CascadedFilter &a, const CascadedFilter &b)
+{
+    temperature_precise worst = 0;
+    for (uint8_t i = 0; i <= NUM_SECTIONS; i++)
+    {
+        for (uint8_t j = 0; j < 3; j++)
+        {
+            worst = std::max(worst, temperature_precise(labs(a.history[i][j] - b.history[i][j])));
+        }
+    }
+    return worst;
+}
+
+template <>
+temperature_precise historyDifference(const FixedFilter &a, const FixedFilter &b)
+{
+    temperature_precise worst = 0;
+    for (uint8_t j = 0; j < 3; j++)
+    {
+        worst = std::max(worst, temperature_precise(labs(a.xv[j] - b.xv[j])));
+        worst = std::max(worst, temperature_precise(labs(a.yv[j] - b.yv[j])));
+    }
+    return worst;
+}
+
+template <class Filter>
+static double nsPerCall(Filter &f, temperature held, uint8_t count, bool closedForm)
+{
+    const int repeats = 20000;
+    Filter start = f;
+    auto begin = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++)
+    {
+        f = start;
+        if (closedForm)
+        {
+            f.addN(held, count);
+        }
+        else
+        {
+            for (uint8_t i = 0; i < count; i++)
+            {
+                f.add(held);
+            }
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - begin;
+    return elapsed.count() / repeats;
+}
+
+// Brings filters with every b value into a random state, holds a new input for 1 to TEMP_SENSOR_MAX_CATCH_UP + 1
+// samples, and compares addN() with the same number of add() calls. The regular outputs may differ by one step, from
+// rounding in the closed form.
+template <class Filter>
+static void checkAddN(const char *name)
+{
+    srand(2);
+    temperature_precise worst = 0;
+    for (uint8_t b = 0; b <= 6; b++)
+    {
+        for (uint16_t trial = 0; trial < 200; trial++)
+        {
+            Filter stepped;
+            stepped.setCoefficients(b);
+            temperature val = intToTemp(rand() % 60 - 10);
+            stepped.init(val);
+            uint16_t warmUp = rand() % 400;
+            for (uint16_t i = 0; i < warmUp; i++)
+            {
+                val += rand() % 33 - 16;
+                stepped.add(val);
+            }
+            temperature held = val + rand() % 2049 - 1024; // up to 2 degrees away
+            uint8_t count = 1 + rand() % (TEMP_SENSOR_MAX_CATCH_UP + 1);
+            Filter closed = stepped;
+            closed.addN(held, count);
+            for (uint8_t i = 0; i < count; i++)
+            {
+                stepped.add(held);
+            }
+            char msg[80];
+            snprintf(msg, sizeof(msg), "%s b=%u count=%u", name, b, count);
+            TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(1, abs(stepped.readOutput() - closed.readOutput()), msg);
+            worst = std::max(worst, historyDifference(stepped, closed));
+        }
+    }
+
+    Filter f;
+    f.setCoefficients(4);
+    f.init(intToTemp(20));
+    uint8_t count = TEMP_SENSOR_MAX_CATCH_UP + 1;
+    double stepNs = nsPerCall(f, intToTemp(21), count, false);
+    double closedNs = nsPerCall(f, intToTemp(21), count, true);
+    char msg[200];
+    snprintf(msg, sizeof(msg), "%s addN: largest history difference with separate adds %ld (1/%ld of a regular step). "
+                               "%u held samples: %.0f ns, %.0f ns with separate adds",
+             name, long(worst), long((1L << TEMP_PRECISE_EXTRA_FRACTION_BITS) / std::max(worst, temperature_precise(1))), count, closedNs, stepNs);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_LESS_THAN(1L << (TEMP_PRECISE_EXTRA_FRACTION_BITS - 3), worst); // stepping truncates, the closed form does not
+}
+
+void test_add_n_matches_separate_adds(void)
+{
+    checkAddN<CascadedFilter>("CascadedFilter");
+    checkAddN<FixedFilter>("FixedFilter");
+}
+
+// A DS18B20 on a beer that warms up at a constant rate: the reading has some noise and is rounded to the 1/16 degree
+// resolution of the sensor.
+class RampSensor : public BasicTempSensor
+{
+  public:
+    double temp; // degrees Celsius
+
+    RampSensor() : temp(20) {}
+    bool isConnected(void) { return true; }
+    bool init() { return true; }
+    temperature read()
+    {
+        double noise = 0; // roughly normal, standard deviation 0.03 degree
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            noise += (rand() / double(RAND_MAX) - 0.5) * 0.05;
+        }
+        return C_OFFSET + temperature(floor((temp + noise) * 16 + 0.5)) * (TEMP_FIXED_POINT_SCALE / 16);
+    }
+};
+
+struct SlopeResult
+{
+    uint16_t usableAfter; // seconds until the slope stays within SLOPE_USABLE of the real slope
+    double rmsError;      // from SLOPE_STEADY_FROM seconds on, in degrees per hour
+    double maxError;
+};
+
+static const uint16_t SLOPE_SECONDS = 3600;
+static const uint16_t SLOPE_STEADY_FROM = 1800;
+static const double SLOPE_USABLE = 0.5; // degrees per hour
+
+// runs a beer sensor with the default filter settings for an hour on a ramp of rate degrees per hour
+static SlopeResult measureSlope(bool regression, double rate)
+{
+    srand(3);
+    RampSensor ramp;
+    TempSensor sensor(TEMP_SENSOR_TYPE_BEER, &ramp);
+    sensor.setFastFilterCoefficients(3);
+    sensor.setSlowFilterCoefficients(4);
+    sensor.setSlopeFilterCoefficients(4);
+    sensor.init();
+    sensor.setSlopeRegression(regression);
+
+    SlopeResult result = {0, 0, 0};
+    double sumSquares = 0;
+    for (uint16_t second = 1; second <= SLOPE_SECONDS; second++)
+    {
+        ramp.temp += rate / 3600;
+        sensor.update();
+        double error = fabs(sensor.readSlope() / double(TEMP_FIXED_POINT_SCALE) - rate);
+        if (error > SLOPE_USABLE)
+        {
+            result.usableAfter = second;
+        }
+        if (second >= SLOPE_STEADY_FROM)
+        {
+            sumSquares += error * error;
+            result.maxError = std::max(result.maxError, error);
+        }
+    }
+    result.rmsError = sqrt(sumSquares / (SLOPE_SECONDS - SLOPE_STEADY_FROM + 1));
+    return result;
+}
+
+void test_slope_estimator_on_noisy_ramp(void)
+{
+    for (double rate : {0.0, 1.0, -2.0})
+    {
+        SlopeResult filtered = measureSlope(false, rate);
+        SlopeResult regression = measureSlope(true, rate);
+        char msg[200];
+        snprintf(msg, sizeof(msg), "ramp %+.0f C/h. Slope filter: usable after %u s, error rms %.3f max %.3f C/h. "
+                                   "Least squares: usable after %u s, error rms %.3f max %.3f C/h",
+                 rate, filtered.usableAfter, filtered.rmsError, filtered.maxError, regression.usableAfter, regression.rmsError, regression.maxError);
+        TEST_MESSAGE(msg);
+        if (rate != 0) // the slope filter starts at 0, which is right for a flat line
+        {
+            TEST_ASSERT_TRUE_MESSAGE(regression.usableAfter < filtered.usableAfter / 2, msg);
+        }
+        TEST_ASSERT_TRUE_MESSAGE(regression.maxError < SLOPE_USABLE, msg);
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_memory);
+    RUN_TEST(test_matches_separate_sections);
+    RUN_TEST(test_add_n_matches_separate_adds);
+    RUN_TEST(test_slope_estimator_on_noisy_ramp);
+    return UNITY_END();
+}
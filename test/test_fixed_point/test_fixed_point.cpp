@@ -0,0 +1,259 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/*
+ * Checks that the code ported to Fixed<> gives the same results as the integer macros and expressions it replaced,
+ * and compares their speed.
+ * The native environment enables FIXED_POINT_CHECK_OVERFLOW. It is disabled here, so the code that is timed is the
+ * code that runs on AVR.
+ * Run with: pio test -e native -f test_fixed_point -v
+ */
+
+#undef FIXED_POINT_CHECK_OVERFLOW
+#define FIXED_POINT_CHECK_OVERFLOW 0
+
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "Brewpi.h"
+#include "FixedPoint.h"
+#include "TemperatureFormats.h"
+#include "TempControl.h"
+
+// the native environment does not build src, the sources under test are compiled with the test
+#include "../../src/TemperatureFormats.cpp"
+
+ControlConstants TempControl::cc;
+
+// The implementations that were replaced by Fixed<>. The multiply functions call constrainTemp16, which the compiler
+// does not inline into them, so the legacy copy is not inlined either: otherwise the timing compares a call with none.
+static __attribute__((noinline)) temperature legacyConstrainTemp16(long_temperature val)
+{
+    if (val < MIN_TEMP)
+    {
+        return MIN_TEMP;
+    }
+    if (val > MAX_TEMP)
+    {
+        return MAX_TEMP;
+    }
+    return val;
+}
+
+static temperature legacyMultiplyFactorTemperatureDiffLong(temperature factor, long_temperature b)
+{
+    return legacyConstrainTemp16(((long_temperature)factor * b) >> TEMP_FIXED_POINT_BITS);
+}
+
+static temperature legacyMultiplyFactorTemperatureDiff(temperature factor, temperature b)
+{
+    return legacyConstrainTemp16(((long_temperature)factor * (long_temperature)b) >> TEMP_FIXED_POINT_BITS);
+}
+
+static temperature legacyMultiplyFactorTemperature(temperature factor, temperature b)
+{
+    return legacyConstrainTemp16(((long_temperature)factor * ((long_temperature)b - C_OFFSET)) >> TEMP_FIXED_POINT_BITS);
+}
+
+// the conversion macros that were replaced by constexpr functions
+#define legacyIntToTempDiff(val) (temperature(val) << TEMP_FIXED_POINT_BITS)
+#define legacyIntToTemp(val) (legacyIntToTempDiff(val) + C_OFFSET)
+#define legacyDoubleToTemp(temp) (((temp)*TEMP_FIXED_POINT_SCALE + C_OFFSET + 0.5) >= MAX_TEMP ? MAX_TEMP : ((temp)*TEMP_FIXED_POINT_SCALE + C_OFFSET - 0.5) <= MIN_TEMP ? MIN_TEMP : (((temp)*TEMP_FIXED_POINT_SCALE + C_OFFSET) < 0) ? temperature((temp)*TEMP_FIXED_POINT_SCALE + C_OFFSET - 0.5) : temperature((temp)*TEMP_FIXED_POINT_SCALE + C_OFFSET + 0.5))
+#define legacyDoubleToTempDiff(temp) (((temp)*TEMP_FIXED_POINT_SCALE + 0.5) >= MAX_TEMP ? MAX_TEMP : ((temp)*TEMP_FIXED_POINT_SCALE - 0.5) <= MIN_TEMP ? MIN_TEMP : (((temp)*TEMP_FIXED_POINT_SCALE) < 0) ? temperature((temp)*TEMP_FIXED_POINT_SCALE - 0.5) : temperature((temp)*TEMP_FIXED_POINT_SCALE + 0.5))
+#define legacyTempPreciseToRegular(val) ((val) >> TEMP_PRECISE_EXTRA_FRACTION_BITS)
+#define legacyTempRegularToPrecise(val) (temperature_precise(val) << TEMP_PRECISE_EXTRA_FRACTION_BITS)
+
+// Times fn over all 16 bit inputs. The fastest of several runs is reported, which leaves out the runs that were
+// interrupted by the scheduler. The results are summed into a volatile.
+template <typename Fn>
+static double nsPerCall(Fn fn)
+{
+    const int runs = 15;
+    volatile long sink = 0;
+    double fastest = 0;
+    for (int r = 0; r < runs; r++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (long i = INT16_MIN; i <= INT16_MAX; i++)
+        {
+            sink += fn(i);
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        if (r == 0 || elapsed.count() < fastest)
+        {
+            fastest = elapsed.count();
+        }
+    }
+    return fastest / 65536;
+}
+
+template <typename Fn, typename LegacyFn>
+static void reportSpeed(const char *name, Fn fn, LegacyFn legacy)
+{
+    char msg[100];
+    snprintf(msg, sizeof(msg), "%s: %.2f ns/call, was %.2f", name, nsPerCall(fn), nsPerCall(legacy));
+    TEST_MESSAGE(msg);
+}
+
+// operands for the two operand functions: every 257th value, which includes both ends of the 16 bit range
+static bool isOperand(long i)
+{
+    return (i - INT16_MIN) % 257 == 0;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_constrain(void)
+{
+    for (long val = -200000; val <= 200000; val++)
+    {
+        TEST_ASSERT_EQUAL_INT16(legacyConstrainTemp16(val), constrainTemp16(val));
+    }
+    reportSpeed(
+        "constrainTemp16", [](long i) { return constrainTemp16(i * 3); }, [](long i) { return legacyConstrainTemp16(i * 3); });
+}
+
+void test_multiply(void)
+{
+    for (long factor = INT16_MIN; factor <= INT16_MAX; factor++)
+    {
+        for (long b = INT16_MIN; b <= INT16_MAX; b++)
+        {
+            if (!isOperand(b))
+            {
+                continue;
+            }
+            TEST_ASSERT_EQUAL_INT16(legacyMultiplyFactorTemperatureDiff(factor, b), multiplyFactorTemperatureDiff(factor, b));
+            TEST_ASSERT_EQUAL_INT16(legacyMultiplyFactorTemperature(factor, b), multiplyFactorTemperature(factor, b));
+            // long operands beyond the 16 bit range, as long as the product fits in 32 bits
+            TEST_ASSERT_EQUAL_INT16(legacyMultiplyFactorTemperatureDiffLong(factor, b * 2), multiplyFactorTemperatureDiffLong(factor, b * 2));
+        }
+    }
+    reportSpeed(
+        "multiplyFactorTemperatureDiff", [](long i) { return multiplyFactorTemperatureDiff(i, 1234); },
+        [](long i) { return legacyMultiplyFactorTemperatureDiff(i, 1234); });
+    reportSpeed(
+        "multiplyFactorTemperature", [](long i) { return multiplyFactorTemperature(i, -1234); },
+        [](long i) { return legacyMultiplyFactorTemperature(i, -1234); });
+}
+
+void test_precision_conversion(void)
+{
+    // the conversions FixedFilter uses between the regular and the precise temperature format
+    for (long val = INT16_MIN; val <= INT16_MAX; val++)
+    {
+        TEST_ASSERT_EQUAL_INT32(legacyTempRegularToPrecise(val), tempRegularToPrecise(val));
+        static const temperature_precise fractions[] = {0, 1, 0x7FFF, 0x8000, 0xFFFF};
+        for (temperature_precise fraction : fractions)
+        {
+            temperature_precise p = legacyTempRegularToPrecise(val) + fraction;
+            TEST_ASSERT_EQUAL_INT16(legacyTempPreciseToRegular(p), tempPreciseToRegular(p));
+        }
+    }
+    reportSpeed(
+        "precise to regular", [](long i) { return tempPreciseToRegular(temperature_precise(i * 65599)); },
+        [](long i) { return temperature(legacyTempPreciseToRegular(temperature_precise(i * 65599))); });
+}
+
+void test_constants(void)
+{
+    // every whole degree and degree difference the regular format holds
+    for (int16_t i = -64; i <= 63; i++)
+    {
+        TEST_ASSERT_EQUAL_INT16(legacyIntToTempDiff(i), intToTempDiff(i));
+        if (i >= -16)
+        {
+            TEST_ASSERT_EQUAL_INT16(legacyIntToTemp(i), intToTemp(i));
+        }
+    }
+    // every 1/1024 degree, including the ties, and values beyond both ends of the range
+    for (long i = -70 * 1024L; i <= 70 * 1024L; i++)
+    {
+        double d = i / 1024.0;
+        TEST_ASSERT_EQUAL_INT16(legacyDoubleToTempDiff(d), doubleToTempDiff(d));
+        TEST_ASSERT_EQUAL_INT16(legacyDoubleToTemp(d + 48), doubleToTemp(d + 48));
+    }
+    // the functions can initialize constants, like the defaults in TempControl.cpp
+    static_assert(intToTemp(20) == -14336, "intToTemp is evaluated at compile time");
+    static_assert(doubleToTempDiff(-0.3) == -154, "doubleToTempDiff is evaluated at compile time");
+}
+
+void test_pid_sum(void)
+{
+    // TempControl::updatePID adds the beer setting and the p, i and d parts in long_temperature
+    for (long setting = INT16_MIN; setting <= INT16_MAX; setting++)
+    {
+        if (!isOperand(setting))
+        {
+            continue;
+        }
+        for (long part = INT16_MIN; part <= INT16_MAX; part += 3)
+        {
+            long_temperature legacy = setting;
+            legacy += part;
+            legacy += -part / 2;
+            legacy += part / 3;
+            FixedLongTemperature sum = FixedTemperature::fromRaw(setting).convert<FixedLongTemperature>();
+            sum += FixedTemperature::fromRaw(part).convert<FixedLongTemperature>();
+            sum += FixedTemperature::fromRaw(-part / 2).convert<FixedLongTemperature>();
+            sum += FixedTemperature::fromRaw(part / 3).convert<FixedLongTemperature>();
+            TEST_ASSERT_EQUAL_INT32(legacy, sum.raw());
+        }
+    }
+}
+
+void test_sizes(void)
+{
+    // the typed formats have the same size as the integer types they wrap
+    TEST_ASSERT_EQUAL(sizeof(temperature), sizeof(FixedTemperature));
+    TEST_ASSERT_EQUAL(sizeof(long_temperature), sizeof(FixedLongTemperature));
+    TEST_ASSERT_EQUAL(sizeof(temperature_precise), sizeof(FixedTemperaturePrecise));
+    // saturation never produces the reserved marker values
+    TEST_ASSERT_EQUAL_INT16(MIN_TEMP, FixedTemperature::minRaw());
+    TEST_ASSERT_EQUAL_INT16(MAX_TEMP, FixedTemperature::maxRaw());
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_sizes);
+    RUN_TEST(test_constrain);
+    RUN_TEST(test_multiply);
+    RUN_TEST(test_precision_conversion);
+    RUN_TEST(test_constants);
+    RUN_TEST(test_pid_sum);
+    return UNITY_END();
+}
@@ -0,0 +1,340 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/*
+ * Counts the bytes SpiLcd sends over the shift register for a steady-state display, and compares them with the
+ * driver that sent every write. The SPI transfers are decoded into a model of the display RAM, which must match the
+ * shadow copy after each second.
+ * Run with: pio test -e native -f test_lcd_bus -v
+ */
+
+#include <unity.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Brewpi.h"
+#include "TicksImpl.h" // before Ticks.h, which needs NoOpDelay from it when ARDUINO is not defined
+#include "SpiLcd.h"
+
+// the native environment does not build src, the sources under test are compiled with the test
+#include "../../src/SpiLcd.cpp"
+#include "../../src/TicksWiring.cpp"
+
+TicksImpl ticks = TicksImpl(TICKS_IMPL_CONFIG);
+
+// HD44780 as seen through the shift register: a nibble is latched on the falling edge of the enable pin
+struct DisplayModel
+{
+    uint8_t lastSpiByte;
+    bool eightBit;
+    bool haveHighNibble;
+    uint8_t highNibble;
+    uint8_t address;
+    char ddram[0x80];
+    uint32_t spiBytes;
+    uint32_t busBytes;
+
+    void reset()
+    {
+        lastSpiByte = 0;
+        eightBit = true;
+        haveHighNibble = false;
+        address = 0;
+        memset(ddram, ' ', sizeof(ddram));
+        spiBytes = 0;
+        busBytes = 0;
+    }
+
+    void spi(uint8_t value)
+    {
+        spiBytes++;
+        bool enableFell = (lastSpiByte & _BV(LCD_SHIFT_ENABLE)) && !(value & _BV(LCD_SHIFT_ENABLE));
+        lastSpiByte = value;
+        if (!enableFell)
+        {
+            return;
+        }
+        uint8_t nibble = value >> 4;
+        bool data = value & _BV(LCD_SHIFT_RS);
+        if (eightBit)
+        {
+            execute(nibble << 4, data);
+        }
+        else if (!haveHighNibble)
+        {
+            highNibble = nibble;
+            haveHighNibble = true;
+        }
+        else
+        {
+            haveHighNibble = false;
+            execute((highNibble << 4) | nibble, data);
+        }
+    }
+
+    void execute(uint8_t value, bool data)
+    {
+        busBytes++;
+        if (data)
+        {
+            ddram[address] = value;
+            address++;
+            if (address == 0x28)
+            {
+                address = 0x40;
+            }
+            else if (address == 0x68)
+            {
+                address = 0x00;
+            }
+        }
+        else if (value & LCD_SETDDRAMADDR)
+        {
+            address = value & 0x7F;
+        }
+        else if (value & 0x20) // function set
+        {
+            eightBit = value & LCD_8BITMODE;
+            haveHighNibble = false;
+        }
+        else if (value == LCD_CLEARDISPLAY)
+        {
+            memset(ddram, ' ', sizeof(ddram));
+            address = 0;
+        }
+        else if ((value & 0xFE) == LCD_RETURNHOME)
+        {
+            address = 0;
+        }
+    }
+
+    void getLine(uint8_t line, char *buffer)
+    {
+        static const uint8_t lineOffsets[] = {0x00, 0x40, 0x14, 0x54};
+        memcpy(buffer, &ddram[lineOffsets[line]], 20);
+        buffer[20] = '\0';
+    }
+};
+
+static DisplayModel model;
+static void spiByteSent(uint8_t value) { model.spi(value); }
+
+// Counts the bus bytes of the driver before the shadow copy was compared: each setCursor() sent an address command
+// and each character was sent.
+struct UnbufferedCost
+{
+    uint8_t pos;
+    uint32_t busBytes;
+
+    void setCursor(uint8_t col, uint8_t)
+    {
+        pos = col;
+        busBytes++;
+    }
+
+    void print(const char *str)
+    {
+        size_t n = strlen(str);
+        pos += n;
+        busBytes += n;
+    }
+
+    void printSpacesToRestOfLine()
+    {
+        while (pos < 20)
+        {
+            pos++;
+            busBytes++;
+        }
+    }
+};
+
+static void formatTemperature(char *buffer, int16_t tenths)
+{
+    sprintf(buffer, "%3d.%d", tenths / 10, tenths % 10);
+}
+
+// One second of the LcdDisplay repaint: the mode, four temperatures and the state line with a running timer. The
+// static text and the state are only printed when they change, as in LcdDisplay.
+template <class Lcd>
+static void repaint(Lcd &lcd, uint32_t second)
+{
+    char buffer[12];
+    if (second == 0)
+    {
+        lcd.setCursor(0, 0);
+        lcd.print("Mode");
+        lcd.setCursor(0, 1);
+        lcd.print("Beer  ");
+        lcd.setCursor(0, 2);
+        lcd.print("Fridge");
+        lcd.setCursor(18, 1);
+        lcd.print("\xDF"
+                  "C");
+        lcd.setCursor(18, 2);
+        lcd.print("\xDF"
+                  "C");
+        lcd.setCursor(0, 3);
+        lcd.print("Cooling for");
+        lcd.printSpacesToRestOfLine();
+    }
+
+    lcd.setCursor(7, 0);
+    lcd.print("Beer Const.");
+    lcd.printSpacesToRestOfLine();
+
+    formatTemperature(buffer, 195 + (second / 20) % 3); // beer temperature changes slowly
+    lcd.setCursor(6, 1);
+    lcd.print(buffer);
+    formatTemperature(buffer, 200);
+    lcd.setCursor(12, 1);
+    lcd.print(buffer);
+    formatTemperature(buffer, 180 + (second / 4) % 10); // fridge temperature changes faster
+    lcd.setCursor(6, 2);
+    lcd.print(buffer);
+    formatTemperature(buffer, 175);
+    lcd.setCursor(12, 2);
+    lcd.print(buffer);
+
+    uint32_t time = second + 3600;
+    uint32_t minutes = time / 60;
+    uint32_t hours = minutes / 60;
+    int length = sprintf(buffer, "%uh%02um%02u", unsigned(hours), unsigned(minutes - hours * 60), unsigned(time - minutes * 60));
+    lcd.setCursor(20 - length, 3);
+    lcd.print(buffer);
+}
+
+// runs the main loop for a second of simulated time, processQueue() is called every 100 us
+static void runSecond(SpiLcd &lcd)
+{
+    unsigned long end = hostMicros() + 1000000;
+    while (hostMicros() < end)
+    {
+        lcd.processQueue();
+        hostMicros() += 100;
+    }
+}
+
+static void checkDisplayMatchesShadowCopy(SpiLcd &lcd, uint32_t second)
+{
+    for (uint8_t line = 0; line < 4; line++)
+    {
+        char expected[21], actual[21];
+        lcd.getLine(line, expected);
+        for (uint8_t i = 0; i < 20; i++)
+        {
+            if (uint8_t(expected[i]) == 0xB0)
+            {
+                expected[i] = char(0xDF); // getLine() converts the degree sign of the display
+            }
+        }
+        model.getLine(line, actual);
+        if (strcmp(expected, actual) != 0)
+        {
+            char msg[96];
+            snprintf(msg, sizeof(msg), "second %u, line %u: display \"%s\", shadow copy \"%s\"", unsigned(second), line, actual, expected);
+            TEST_FAIL_MESSAGE(msg);
+        }
+    }
+}
+
+static const uint32_t SECONDS = 600;
+
+// bus bytes per second that SpiLcd sends over SECONDS of steady state, optionally with the once per second checkContent()
+static double measure(bool withCheckContent, double &spiBytesPerSecond)
+{
+    static SpiLcd lcd;
+    model.reset();
+    hostSpiByteSent() = spiByteSent;
+
+    lcd.init();
+    lcd.begin(20, 4);
+    repaint(lcd, 0);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        runSecond(lcd); // the display is given 2 s to power up before it is initialized
+    }
+    checkDisplayMatchesShadowCopy(lcd, 0);
+
+    uint32_t busStart = model.busBytes;
+    uint32_t spiStart = model.spiBytes;
+    for (uint32_t second = 1; second <= SECONDS; second++)
+    {
+        repaint(lcd, second);
+        if (withCheckContent)
+        {
+            lcd.checkContent();
+        }
+        runSecond(lcd);
+        checkDisplayMatchesShadowCopy(lcd, second);
+    }
+    hostSpiByteSent() = 0;
+    spiBytesPerSecond = double(model.spiBytes - spiStart) / SECONDS;
+    return double(model.busBytes - busStart) / SECONDS;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_bus_bytes_per_second(void)
+{
+    UnbufferedCost unbuffered = {0, 0};
+    repaint(unbuffered, 0);
+    unbuffered.busBytes = 0;
+    for (uint32_t second = 1; second <= SECONDS; second++)
+    {
+        repaint(unbuffered, second);
+    }
+    double before = double(unbuffered.busBytes) / SECONDS;
+
+    double spiRepaint, spiChecked;
+    double repaintOnly = measure(false, spiRepaint);
+    double checked = measure(true, spiChecked);
+
+    // a bus byte is two nibbles, each nibble is three transfers: the data and the rising and falling enable pulse
+    char msg[160];
+    snprintf(msg, sizeof(msg), "every write sent: %.1f bus bytes/s (%.0f SPI transfers/s)", before, before * 7);
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "changed cells only: %.1f bus bytes/s (%.0f SPI transfers/s)", repaintOnly, spiRepaint);
+    TEST_MESSAGE(msg);
+    snprintf(msg, sizeof(msg), "with checkContent() every second: %.1f bus bytes/s (%.0f SPI transfers/s)", checked, spiChecked);
+    TEST_MESSAGE(msg);
+
+    TEST_ASSERT_TRUE(repaintOnly < before / 4);
+    // the periodic resend must stay a small part of the regular traffic
+    TEST_ASSERT_TRUE(checked < repaintOnly + 1);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bus_bytes_per_second);
+    return UNITY_END();
+}
@@ -0,0 +1,169 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/*
+ * Tests for reading the terminated number argument of a serial command, with bytes that arrive one by one as they do
+ * over the serial port.
+ * Run with: pio test -e native -f test_stream_parse -v
+ */
+
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <Arduino.h>
+#include "StreamParse.h"
+
+// A serial receive buffer that is filled over simulated time: each byte becomes available at its own arrival time
+struct TimedStream
+{
+    const char *bytes;
+    unsigned long arrival[16];
+    uint8_t length;
+    uint8_t next;
+
+    // the bytes arrive interval us apart, the first one at start
+    void receive(const char *text, unsigned long start, unsigned long interval)
+    {
+        bytes = text;
+        length = strlen(text);
+        next = 0;
+        for (uint8_t i = 0; i < length; i++)
+        {
+            arrival[i] = start + i * interval;
+        }
+    }
+
+    int available()
+    {
+        uint8_t n = 0;
+        while (next + n < length && arrival[next + n] <= hostMicros())
+        {
+            n++;
+        }
+        return n;
+    }
+
+    int peek() { return available() ? bytes[next] : -1; }
+    int read() { return available() ? bytes[next++] : -1; }
+};
+
+struct HostDelay
+{
+    void microseconds(uint32_t micros) { delayMicroseconds(micros); }
+};
+
+static TimedStream stream;
+static HostDelay delay100;
+
+// at 57600 baud, a byte takes 174 us
+static const unsigned long BYTE_MICROS = 174;
+static const uint16_t RETRIES = 20;
+
+void setUp(void)
+{
+    hostMicros() = 0;
+}
+
+void tearDown(void) {}
+
+// 'k' was just read, the digits of the version are still arriving
+void test_digits_arriving_after_the_command(void)
+{
+    uint16_t value;
+    stream.receive("1234\n", BYTE_MICROS, BYTE_MICROS);
+    TEST_ASSERT_EQUAL(0, stream.available());
+    TEST_ASSERT_TRUE(readTerminatedNumber(stream, delay100, RETRIES, value));
+    TEST_ASSERT_EQUAL(1234, value);
+    TEST_ASSERT_EQUAL(-1, stream.peek());
+}
+
+// the client wrote the command and the version in separate writes, with a gap between them
+void test_digits_in_a_separate_read(void)
+{
+    uint16_t value;
+    stream.receive("42\r", 1500, BYTE_MICROS);
+    TEST_ASSERT_TRUE(readTerminatedNumber(stream, delay100, RETRIES, value));
+    TEST_ASSERT_EQUAL(42, value);
+}
+
+void test_next_command_is_left_in_the_stream(void)
+{
+    uint16_t value;
+    stream.receive("7\nt", 0, BYTE_MICROS);
+    TEST_ASSERT_TRUE(readTerminatedNumber(stream, delay100, RETRIES, value));
+    TEST_ASSERT_EQUAL(7, value);
+    hostMicros() += 1000;
+    TEST_ASSERT_EQUAL('t', stream.read());
+}
+
+void test_only_a_newline(void)
+{
+    uint16_t value;
+    stream.receive("\n", BYTE_MICROS, BYTE_MICROS);
+    TEST_ASSERT_FALSE(readTerminatedNumber(stream, delay100, RETRIES, value));
+    TEST_ASSERT_EQUAL(-1, stream.peek());
+}
+
+// nothing follows the command: the wait is bounded by the retries
+void test_nothing_received(void)
+{
+    uint16_t value;
+    stream.receive("", 0, 0);
+    TEST_ASSERT_FALSE(readTerminatedNumber(stream, delay100, RETRIES, value));
+    TEST_ASSERT_EQUAL(RETRIES * 100, hostMicros());
+}
+
+void test_unterminated_number(void)
+{
+    uint16_t value;
+    stream.receive("12", 0, BYTE_MICROS);
+    TEST_ASSERT_FALSE(readTerminatedNumber(stream, delay100, RETRIES, value));
+}
+
+void test_other_byte_ends_the_number_without_being_consumed(void)
+{
+    uint16_t value;
+    stream.receive("12t", 0, BYTE_MICROS);
+    TEST_ASSERT_FALSE(readTerminatedNumber(stream, delay100, RETRIES, value));
+    TEST_ASSERT_EQUAL('t', stream.read());
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_digits_arriving_after_the_command);
+    RUN_TEST(test_digits_in_a_separate_read);
+    RUN_TEST(test_next_command_is_left_in_the_stream);
+    RUN_TEST(test_only_a_newline);
+    RUN_TEST(test_nothing_received);
+    RUN_TEST(test_unterminated_number);
+    RUN_TEST(test_other_byte_ends_the_number_without_being_consumed);
+    return UNITY_END();
+}
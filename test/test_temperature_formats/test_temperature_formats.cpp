@@ -0,0 +1,611 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/*
+ * Conformance and throughput tests for the conversions in TemperatureFormats.cpp.
+ * Each function is swept over every 16 bit input, in Celsius and in Fahrenheit, and compared with a double precision
+ * reference that rounds once. The sweeps are split over all cores. The maximum error, the number of mismatches and the
+ * time per call are reported, the time is measured on a single thread.
+ * Run with: pio test -e native -f test_temperature_formats -v
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Brewpi.h"
+#include "TemperatureFormats.h"
+#include "TempControl.h"
+
+// the native environment does not build src, the sources under test are compiled with the test
+#include "../../src/TemperatureFormats.cpp"
+
+// the Arduino stand-in defines min and max as macros, which hide std::min and std::max
+#undef min
+#undef max
+
+ControlConstants TempControl::cc;
+
+static const char formats[] = {'C', 'F'};
+
+// Collects the result of a sweep: the number of inputs that differ from the reference, the largest difference,
+// and the first input that differs.
+struct Sweep
+{
+    const char *name;
+    uint32_t count;
+    uint32_t mismatches;
+    long maxError;
+    long firstMismatch;
+
+    Sweep(const char *name) : name(name), count(0), mismatches(0), maxError(0), firstMismatch(0) {}
+
+    void check(long input, long actual, long expected)
+    {
+        count++;
+        long error = labs(actual - expected);
+        if (error != 0)
+        {
+            if (mismatches == 0)
+            {
+                firstMismatch = input;
+            }
+            mismatches++;
+        }
+        if (error > maxError)
+        {
+            maxError = error;
+        }
+    }
+
+    // adds the result of a sweep over part of the inputs, which may run on another thread
+    void merge(const Sweep &part)
+    {
+        static std::mutex mutex;
+        std::lock_guard<std::mutex> lock(mutex);
+        count += part.count;
+        if (part.mismatches != 0 && (mismatches == 0 || part.firstMismatch < firstMismatch))
+        {
+            firstMismatch = part.firstMismatch;
+        }
+        mismatches += part.mismatches;
+        maxError = std::max(maxError, part.maxError);
+    }
+
+    // reports the result, and the time per call when it was measured
+    void report(double nsPerCall = -1)
+    {
+        char msg[160];
+        int n = snprintf(msg, sizeof(msg), "%s %c: %lu inputs, %lu mismatches (first %ld), max error %ld",
+                         name, tempControl.cc.tempFormat, (unsigned long)count, (unsigned long)mismatches, firstMismatch, maxError);
+        if (nsPerCall >= 0)
+        {
+            snprintf(msg + n, sizeof(msg) - n, ", %.1f ns/call", nsPerCall);
+        }
+        TEST_MESSAGE(msg);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, mismatches, msg);
+    }
+};
+
+// Times fn over all 16 bit inputs. The results are summed into a volatile, so the calls are not optimized away.
+template <typename Fn>
+static double nsPerCall(Fn fn)
+{
+    volatile long sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = INT16_MIN; i <= INT16_MAX; i++)
+    {
+        sink += fn(i);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / 65536;
+}
+
+// Splits the inputs first..last into one range per core and calls body(rangeFirst, rangeLast) for each range on its
+// own thread. The body must not use the Unity asserts, and merges its results into the sweeps when done.
+template <typename Fn>
+static void forEachRange(long first, long last, Fn body)
+{
+    long threads = std::max(1u, std::thread::hardware_concurrency());
+    long rangeSize = (last - first + threads) / threads;
+    std::vector<std::thread> workers;
+    for (long rangeFirst = first; rangeFirst <= last; rangeFirst += rangeSize)
+    {
+        workers.emplace_back(body, rangeFirst, std::min(last, rangeFirst + rangeSize - 1));
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+static bool fahrenheit()
+{
+    return tempControl.cc.tempFormat == 'F';
+}
+
+// internal temperature to user format, both as 9 bit fixed point
+static double refFromInternal(long t)
+{
+    double c = t - C_OFFSET;
+    return fahrenheit() ? c * 9 / 5 + (32 << TEMP_FIXED_POINT_BITS) : c;
+}
+
+// user format to internal temperature, both as 9 bit fixed point
+static double refToInternal(double v)
+{
+    double c = fahrenheit() ? (v - (32 << TEMP_FIXED_POINT_BITS)) * 5 / 9 : v;
+    return c + C_OFFSET;
+}
+
+// internal temperature to tenths of a degree in user format. This is exact: the scaling is a multiply and a power of 2.
+static double refTenths(long t)
+{
+    double c = t - C_OFFSET;
+    return fahrenheit() ? (c * 18 + (320 << TEMP_FIXED_POINT_BITS)) / TEMP_FIXED_POINT_SCALE : c * 10 / TEMP_FIXED_POINT_SCALE;
+}
+
+static double refDiffFromInternal(long d)
+{
+    return fahrenheit() ? d * 9.0 / 5 : d;
+}
+
+static double refDiffToInternal(double d)
+{
+    return fahrenheit() ? d * 5 / 9 : d;
+}
+
+// round half away from zero, like the firmware
+static long roundAway(double x)
+{
+    return long(x < 0 ? -floor(-x + 0.5) : floor(x + 0.5));
+}
+
+static long saturate16(long x)
+{
+    return x > MAX_TEMP ? MAX_TEMP : x < MIN_TEMP ? MIN_TEMP : x;
+}
+
+// Formats a fixed point value like fixedPointToString: a sign or space, the integer part and numDecimals decimals,
+// rounded half away from zero and truncated to maxLength - 1 characters.
+static void refFormat(char *s, long raw, uint8_t numDecimals, uint8_t maxLength)
+{
+    long scale = numDecimals == 1 ? 10 : numDecimals == 2 ? 100 : 1000;
+    long scaled = long(floor(labs(raw) * double(scale) / TEMP_FIXED_POINT_SCALE + 0.5));
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%c%ld.%0*ld", raw < 0 ? '-' : ' ', scaled / scale, int(numDecimals), scaled % scale);
+    buf[maxLength - 1] = '\0';
+    strcpy(s, buf);
+}
+
+// The vsnprintf based formatter that fixedPointToString replaced, kept as the reference for the exact output and
+// as the baseline for the throughput comparison.
+static char *printfFixedPointToString(char *s, long_temperature rawValue, uint8_t numDecimals, uint8_t maxLength)
+{
+    s[0] = ' ';
+    if (rawValue < 0l)
+    {
+        s[0] = '-';
+        rawValue = -rawValue;
+    }
+    int intPart = rawValue >> TEMP_FIXED_POINT_BITS;
+    const char *fmt;
+    uint16_t scale;
+    switch (numDecimals)
+    {
+    case 1:
+        fmt = "%d.%01d";
+        scale = 10;
+        break;
+    case 2:
+        fmt = "%d.%02d";
+        scale = 100;
+        break;
+    default:
+        fmt = "%d.%03d";
+        scale = 1000;
+    }
+    uint16_t fracPart = ((rawValue & TEMP_FIXED_POINT_MASK) * scale + TEMP_FIXED_POINT_SCALE / 2) >> TEMP_FIXED_POINT_BITS;
+    if (fracPart >= scale)
+    {
+        intPart++;
+        fracPart = 0;
+    }
+    snprintf(&s[1], maxLength - 1, fmt, intPart, fracPart);
+    return s;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_convert_from_internal(void)
+{
+    for (char format : formats)
+    {
+        tempControl.cc.tempFormat = format;
+        Sweep sweep("convertFromInternalTemp");
+        Sweep diffSweep("convertFromInternalTempDiff");
+        forEachRange(INT16_MIN, INT16_MAX, [&](long first, long last) {
+            Sweep part(sweep.name);
+            Sweep diffPart(diffSweep.name);
+            for (long t = first; t <= last; t++)
+            {
+                part.check(t, convertFromInternalTemp(t), roundAway(refFromInternal(t)));
+                diffPart.check(t, convertFromInternalTempDiff(t), roundAway(refDiffFromInternal(t)));
+            }
+            sweep.merge(part);
+            diffSweep.merge(diffPart);
+        });
+        sweep.report(nsPerCall([](long t) { return convertFromInternalTemp(t); }));
+        diffSweep.report(nsPerCall([](long t) { return convertFromInternalTempDiff(t); }));
+    }
+}
+
+void test_convert_to_internal(void)
+{
+    for (char format : formats)
+    {
+        tempControl.cc.tempFormat = format;
+        Sweep sweep("convertToInternalTemp");
+        Sweep diffSweep("convertToInternalTempDiff");
+        forEachRange(INT16_MIN, INT16_MAX, [&](long first, long last) {
+            Sweep part(sweep.name);
+            Sweep diffPart(diffSweep.name);
+            for (long v = first; v <= last; v++)
+            {
+                part.check(v, convertToInternalTemp(v), roundAway(refToInternal(v)));
+                diffPart.check(v, convertToInternalTempDiff(v), roundAway(refDiffToInternal(v)));
+            }
+            sweep.merge(part);
+            diffSweep.merge(diffPart);
+        });
+        sweep.report(nsPerCall([](long v) { return convertToInternalTemp(v); }));
+        diffSweep.report(nsPerCall([](long v) { return convertToInternalTempDiff(v); }));
+    }
+}
+
+void test_fixed_to_tenths(void)
+{
+    for (char format : formats)
+    {
+        tempControl.cc.tempFormat = format;
+        Sweep sweep("fixedToTenths");
+        forEachRange(INT16_MIN, INT16_MAX, [&](long first, long last) {
+            Sweep part(sweep.name);
+            for (long t = first; t <= last; t++)
+            {
+                part.check(t, fixedToTenths(t), roundAway(refTenths(t)));
+            }
+            sweep.merge(part);
+        });
+        sweep.report(nsPerCall([](long t) { return fixedToTenths(t); }));
+    }
+}
+
+void test_tenths_to_fixed(void)
+{
+    for (char format : formats)
+    {
+        tempControl.cc.tempFormat = format;
+        Sweep sweep("tenthsToFixed");
+        forEachRange(INT16_MIN, INT16_MAX, [&](long first, long last) {
+            Sweep part(sweep.name);
+            for (long tenths = first; tenths <= last; tenths++)
+            {
+                double value = tenths * double(TEMP_FIXED_POINT_SCALE) / 10;
+                part.check(tenths, tenthsToFixed(tenths), saturate16(roundAway(refToInternal(value))));
+            }
+            sweep.merge(part);
+        });
+        sweep.report(nsPerCall([](long tenths) { return tenthsToFixed(tenths); }));
+    }
+}
+
+void test_format(void)
+{
+    char actual[16];
+    for (char format : formats)
+    {
+        tempControl.cc.tempFormat = format;
+        for (uint8_t decimals = 1; decimals <= 3; decimals++)
+        {
+            char name[32];
+            char diffName[32];
+            snprintf(name, sizeof(name), "tempToString %u decimals", decimals);
+            snprintf(diffName, sizeof(diffName), "tempDiffToString %u decimals", decimals);
+            Sweep sweep(name);
+            Sweep diffSweep(diffName);
+            forEachRange(MIN_TEMP, MAX_TEMP, [&](long first, long last) {
+                Sweep part(name);
+                Sweep diffPart(diffName);
+                char actual[16];
+                char expected[16];
+                for (long t = first; t <= last; t++)
+                {
+                    // maxLength 12 never truncates, 5 always does
+                    for (uint8_t maxLength = 5; maxLength <= 12; maxLength += 7)
+                    {
+                        tempToString(actual, t, decimals, maxLength);
+                        refFormat(expected, convertFromInternalTemp(t), decimals, maxLength);
+                        part.check(t, strcmp(actual, expected) != 0, 0);
+                        tempDiffToString(actual, t, decimals, maxLength);
+                        refFormat(expected, convertFromInternalTempDiff(t), decimals, maxLength);
+                        diffPart.check(t, strcmp(actual, expected) != 0, 0);
+                    }
+                }
+                sweep.merge(part);
+                diffSweep.merge(diffPart);
+            });
+            sweep.report(nsPerCall([decimals, &actual](long t) { return tempToString(actual, t, decimals, 12)[1]; }));
+            diffSweep.report(nsPerCall([decimals, &actual](long t) { return tempDiffToString(actual, t, decimals, 12)[1]; }));
+        }
+    }
+    tempToString(actual, INVALID_TEMP, 1, 12);
+    TEST_ASSERT_EQUAL_STRING("null", actual);
+    tempToString(actual, DISABLED_TEMP, 1, 12);
+    TEST_ASSERT_EQUAL_STRING("null", actual);
+}
+
+// The display redraws a temperature when tempToShownTenths() changes, which must be exactly when the text changes
+void test_shown_tenths(void)
+{
+    for (char format : formats)
+    {
+        tempControl.cc.tempFormat = format;
+        Sweep sweep("tempToShownTenths");
+        forEachRange(MIN_TEMP, MAX_TEMP - 1, [&](long first, long last) {
+            Sweep part(sweep.name);
+            char text[9];
+            char nextText[9];
+            for (long t = first; t <= last; t++)
+            {
+                tempToString(text, t, 1, 9);
+                tempToString(nextText, t + 1, 1, 9);
+                bool textChanged = strcmp(text, nextText) != 0;
+                bool shownChanged = tempToShownTenths(t) != tempToShownTenths(t + 1);
+                part.check(t, shownChanged, textChanged);
+            }
+            sweep.merge(part);
+        });
+        sweep.report(nsPerCall([](long t) { return tempToShownTenths(t); }));
+    }
+}
+
+// the strings that are parsed, formatted once so that formatting is not included in the parse timing
+static char parseInput[65536][12];
+
+void test_format_matches_printf(void)
+{
+    char actual[16];
+    for (uint8_t decimals = 0; decimals <= 4; decimals++) // 0 and 4 fall back to 3 decimals
+    {
+        char name[40];
+        snprintf(name, sizeof(name), "fixedPointToString %u decimals", decimals);
+        tempControl.cc.tempFormat = 'C'; // only used in the report
+        Sweep sweep(name);
+        forEachRange(INT16_MIN, INT16_MAX, [&](long first, long last) {
+            Sweep part(name);
+            char actual[16];
+            char expected[16];
+            for (long raw = first; raw <= last; raw++)
+            {
+                for (uint8_t maxLength = 2; maxLength <= 12; maxLength++)
+                {
+                    memset(actual, 'x', sizeof(actual));
+                    memset(expected, 'x', sizeof(expected));
+                    fixedPointToString(actual, long_temperature(raw), decimals, maxLength);
+                    printfFixedPointToString(expected, long_temperature(raw), decimals, maxLength);
+                    part.check(raw, memcmp(actual, expected, sizeof(actual)) != 0, 0);
+                }
+            }
+            sweep.merge(part);
+        });
+        sweep.report(nsPerCall([decimals, &actual](long raw) { return fixedPointToString(actual, long_temperature(raw), decimals, 12)[1]; }));
+        char msg[80];
+        snprintf(msg, sizeof(msg), "vsnprintf based formatter for comparison: %.1f ns/call", nsPerCall([decimals, &actual](long raw) {
+                     return printfFixedPointToString(actual, long_temperature(raw), decimals, 12)[1];
+                 }));
+        TEST_MESSAGE(msg);
+    }
+}
+
+void test_parse(void)
+{
+    for (char format : formats)
+    {
+        tempControl.cc.tempFormat = format;
+        Sweep sweep("stringToTemp");
+        for (long t = INT16_MIN; t <= INT16_MAX; t++)
+        {
+            tempToString(parseInput[t - INT16_MIN], t, 3, 12);
+        }
+        for (long t = MIN_TEMP; t <= MAX_TEMP; t++)
+        {
+            // a temperature formatted with 3 decimals parses back to the same value
+            temperature parsed = INVALID_TEMP;
+            TEST_ASSERT_TRUE_MESSAGE(stringToTemp(&parsed, parseInput[t - INT16_MIN]), parseInput[t - INT16_MIN]);
+            sweep.check(t, parsed, t);
+        }
+        sweep.report(nsPerCall([](long t) {
+            temperature parsed = 0;
+            stringToTemp(&parsed, parseInput[t - INT16_MIN]);
+            return parsed;
+        }));
+
+        Sweep diffSweep("stringToTempDiff");
+        for (long d = INT16_MIN; d <= INT16_MAX; d++)
+        {
+            snprintf(parseInput[d - INT16_MIN], 12, "%.3f", d / 1000.0);
+        }
+        for (long d = INT16_MIN; d <= INT16_MAX; d++)
+        {
+            // the parsed value is the nearest fixed point value to the decimal string
+            temperature parsed = INVALID_TEMP;
+            TEST_ASSERT_TRUE_MESSAGE(stringToTempDiff(&parsed, parseInput[d - INT16_MIN]), parseInput[d - INT16_MIN]);
+            diffSweep.check(d, parsed, saturate16(roundAway(refDiffToInternal(d * double(TEMP_FIXED_POINT_SCALE) / 1000))));
+        }
+        diffSweep.report(nsPerCall([](long d) {
+            temperature parsed = 0;
+            stringToTempDiff(&parsed, parseInput[d - INT16_MIN]);
+            return parsed;
+        }));
+    }
+}
+
+// The strtol based parser that parseFixedPoint replaced, kept as the baseline for the throughput comparison.
+static bool legacyStringToFixedPoint(long_temperature *result, const char *numberString)
+{
+    char *end;
+    bool positive = (0 == strchr(numberString, '-'));
+    long_temperature newValue = my_strtol(numberString, &end);
+    if (invalidStrtolResult(numberString, end))
+    {
+        return false;
+    }
+    newValue = newValue << TEMP_FIXED_POINT_BITS;
+    long_temperature decimalValue = 0;
+    const char *decimalPtr = strchr(numberString, '.');
+    if (decimalPtr != 0)
+    {
+        decimalPtr++;
+        decimalValue = my_strtol(decimalPtr, &end) << TEMP_FIXED_POINT_BITS;
+        if (invalidStrtolResult(decimalPtr, end))
+        {
+            return false;
+        }
+        uint8_t charsAfterPoint = end - decimalPtr;
+        while (charsAfterPoint-- > 0)
+        {
+            decimalValue = (decimalValue + 5) / 10;
+        }
+    }
+    *result = positive ? newValue + decimalValue : newValue - decimalValue;
+    return true;
+}
+
+void test_parse_syntax(void)
+{
+    struct
+    {
+        const char *s;
+        bool valid;
+        long_temperature expected;
+    } cases[] = {
+        {"21.5", true, 11008},
+        {"  21.5", true, 11008},
+        {"+21.5", true, 11008},
+        {"-21.5", true, -11008},
+        {"21", true, 10752},
+        {"21.", true, 10752},
+        {"21.5 ", true, 11008},
+        {"0.001", true, 1},
+        {"-0.0009", true, 0},
+        {"1.0000000001", true, 512},
+        {"999999", true, 1000l << TEMP_FIXED_POINT_BITS}, // the integer part saturates
+        {"", false, 0},
+        {"-", false, 0},
+        {"+", false, 0},
+        {".5", false, 0},
+        {"21.5x", false, 0},
+        {"2 1", true, 1024}, // parsing stops at a space
+        {"+-1", false, 0},
+    };
+    for (auto &c : cases)
+    {
+        long_temperature parsed = INVALID_TEMP_LONG;
+        TEST_ASSERT_EQUAL_MESSAGE(c.valid, stringToFixedPoint(&parsed, c.s), c.s);
+        if (c.valid)
+        {
+            TEST_ASSERT_EQUAL_MESSAGE(c.expected, parsed, c.s);
+        }
+    }
+}
+
+void test_fixed_point_round_trip(void)
+{
+    char s[16];
+    tempControl.cc.tempFormat = 'C'; // only used in the report, fixed point values are not converted
+    Sweep sweep("stringToFixedPoint");
+    Sweep plusSweep("stringToFixedPoint with '+'");
+    for (long raw = INT16_MIN; raw <= INT16_MAX; raw++)
+    {
+        // one step of the fixed point format is larger than 0.001, so 3 decimals identify the value
+        fixedPointToString(s, long_temperature(raw), 3, 12);
+        long_temperature parsed = INVALID_TEMP_LONG;
+        TEST_ASSERT_TRUE_MESSAGE(stringToFixedPoint(&parsed, s), s);
+        sweep.check(raw, parsed, raw);
+        if (raw >= 0)
+        {
+            s[0] = '+';
+            parsed = INVALID_TEMP_LONG;
+            TEST_ASSERT_TRUE_MESSAGE(stringToFixedPoint(&parsed, s), s);
+            plusSweep.check(raw, parsed, raw);
+        }
+        snprintf(parseInput[raw - INT16_MIN], 12, "%.3f", raw / 1000.0);
+    }
+    sweep.report(nsPerCall([](long raw) {
+        long_temperature parsed = 0;
+        stringToFixedPoint(&parsed, parseInput[raw - INT16_MIN]);
+        return parsed;
+    }));
+    plusSweep.report();
+
+    char msg[80];
+    snprintf(msg, sizeof(msg), "strtol based parser for comparison: %.1f ns/call", nsPerCall([](long raw) {
+                 long_temperature parsed = 0;
+                 legacyStringToFixedPoint(&parsed, parseInput[raw - INT16_MIN]);
+                 return parsed;
+             }));
+    TEST_MESSAGE(msg);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_convert_from_internal);
+    RUN_TEST(test_convert_to_internal);
+    RUN_TEST(test_fixed_to_tenths);
+    RUN_TEST(test_tenths_to_fixed);
+    RUN_TEST(test_format);
+    RUN_TEST(test_shown_tenths);
+    RUN_TEST(test_format_matches_printf);
+    RUN_TEST(test_parse);
+    RUN_TEST(test_parse_syntax);
+    RUN_TEST(test_fixed_point_round_trip);
+    return UNITY_END();
+}
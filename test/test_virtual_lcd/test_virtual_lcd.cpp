@@ -0,0 +1,260 @@
+/* Copyright (C) 2019 Lee C. Bussy (@LBussy)
+
+This file is part of LBussy's BrewPi Firmware Remix (BrewPi-Firmware-RMX).
+
+BrewPi Firmware RMX is free software: you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the
+License, or (at your option) any later version.
+
+BrewPi Firmware RMX is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with BrewPi Firmware RMX. If not, see <https://www.gnu.org/licenses/>.
+
+These scripts were originally a part of firmware, a part of
+the BrewPi project. Legacy support (for the very popular Arduino
+controller) seems to have been discontinued in favor of new hardware.
+
+All credit for the original firmware goes to @elcojacobs,
+@m-mcgowan, @elnicoCZ, @ntfreak, @Gargy007 and I'm sure many more
+contributors around the world. My apologies if I have missed anyone;
+those were the names listed as contributors on the Legacy branch.
+
+See: 'original-license.md' for notes about the original project's
+license and credits. */
+
+/*
+ * Draws the mode and state lines of LcdDisplay on the VirtualLcd driver and compares the recorded frames with golden
+ * frames: the display content, the characters written and changed, and the text written by printFrame().
+ * Run with: pio test -e native -f test_virtual_lcd -v
+ */
+
+#include <unity.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Brewpi.h"
+#include "TicksImpl.h" // before Ticks.h, which needs NoOpDelay from it when ARDUINO is not defined
+#include "Display.h"
+#include "TempControl.h"
+
+// the native environment does not build src, the sources under test are compiled with the test
+#include "../../src/BrewpiStrings.cpp"
+#include "../../src/DisplayLcd.cpp"
+#include "../../src/NullLcdDriver.cpp"
+#include "../../src/TemperatureFormats.cpp"
+#include "../../src/TicksWiring.cpp"
+#include "../../src/VirtualLcd.cpp"
+
+TicksImpl ticks = TicksImpl(TICKS_IMPL_CONFIG);
+LcdDisplay display;
+
+// TempControl.cpp is not compiled. The members that the display reads are defined here and take their values from the
+// scenario, updateState() copies the state.
+static states scenarioState;
+static tcduration_t scenarioSinceIdle;
+static tcduration_t scenarioSinceCooling;
+static tcduration_t scenarioSinceHeating;
+
+TempControl tempControl;
+TempSensor *TempControl::beerSensor;
+TempSensor *TempControl::fridgeSensor;
+BasicTempSensor *TempControl::ambientSensor;
+ControlConstants TempControl::cc;
+ControlSettings TempControl::cs;
+tcduration_t TempControl::waitTime;
+states TempControl::state;
+bool TempControl::doorOpen;
+
+void TempControl::updateState(void) { state = scenarioState; }
+tcduration_t TempControl::timeSinceCooling(void) { return scenarioSinceCooling; }
+tcduration_t TempControl::timeSinceHeating(void) { return scenarioSinceHeating; }
+tcduration_t TempControl::timeSinceIdle(void) { return scenarioSinceIdle; }
+temperature TempControl::getBeerTemp(void) { return DISABLED_TEMP; }
+temperature TempControl::getBeerSetting(void) { return cs.beerSetting; }
+temperature TempControl::getFridgeTemp(void) { return DISABLED_TEMP; }
+temperature TempControl::getFridgeSetting(void) { return cs.fridgeSetting; }
+
+static void setState(states state, tcduration_t sinceIdle, tcduration_t sinceCooling, tcduration_t sinceHeating)
+{
+    scenarioState = state;
+    scenarioSinceIdle = sinceIdle;
+    scenarioSinceCooling = sinceCooling;
+    scenarioSinceHeating = sinceHeating;
+    tempControl.updateState();
+}
+
+struct GoldenFrame
+{
+    uint16_t chars;
+    uint16_t changed;
+    uint16_t commands;
+    const char *lines[4];
+};
+
+// completes a frame, which must be added to the log and match the golden frame
+static void checkFrame(const GoldenFrame &golden)
+{
+    VirtualLcd &lcd = display.getLcd();
+    uint32_t framesBefore = lcd.stats().frames;
+    display.processQueue();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(framesBefore + 1, lcd.stats().frames, "no frame was recorded");
+
+    const VirtualLcdFrame &frame = lcd.frame(lcd.frameCount() - 1);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        TEST_ASSERT_EQUAL_STRING(golden.lines[i], frame.content[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(golden.chars, frame.chars, "chars");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(golden.changed, frame.changed, "changed");
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(golden.commands, frame.commands, "commands");
+}
+
+// a redraw of unchanged values must not draw anything, so no frame is recorded
+static void checkNoFrame(void)
+{
+    VirtualLcd &lcd = display.getLcd();
+    uint32_t framesBefore = lcd.stats().frames;
+    display.processQueue();
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(framesBefore, lcd.stats().frames, "an unchanged field was drawn");
+}
+
+static void startDisplay(void)
+{
+    tempControl.cc.tempFormat = 'C';
+    tempControl.cs.mode = MODE_BEER_CONSTANT;
+    setState(IDLE, 0, 125, 300);
+    display.init();
+    display.processQueue(); // the clear and home of init() are a frame without characters
+    display.getLcd().resetStats();
+    display.printStationaryText();
+    display.printMode();
+    display.printState();
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_print_mode(void)
+{
+    startDisplay();
+    // the stationary text is 20 characters and 5 cursor moves, the mode 13 and 1, the state 20 and 1, the time 5 and 1
+    checkFrame({58, 42, 8,
+                {"Mode   Beer Const.  ",
+                 "Beer              \xDF" "C",
+                 "Fridge            \xDF" "C",
+                 "Idling for     02m05"}});
+
+    display.printMode();
+    checkNoFrame();
+
+    tempControl.cs.mode = MODE_FRIDGE_CONSTANT;
+    display.printMode();
+    checkFrame({13, 13, 1,
+                {"Mode   Fridge Const.",
+                 "Beer              \xDF" "C",
+                 "Fridge            \xDF" "C",
+                 "Idling for     02m05"}});
+
+    tempControl.cs.mode = MODE_OFF;
+    display.printMode();
+    checkFrame({13, 12, 1,
+                {"Mode   Off          ",
+                 "Beer              \xDF" "C",
+                 "Fridge            \xDF" "C",
+                 "Idling for     02m05"}});
+
+    tempControl.cs.mode = MODE_TEST;
+    display.printMode();
+    checkFrame({13, 12, 1,
+                {"Mode   ** Testing **",
+                 "Beer              \xDF" "C",
+                 "Fridge            \xDF" "C",
+                 "Idling for     02m05"}});
+}
+
+void test_print_state(void)
+{
+    startDisplay();
+    display.processQueue();
+
+    // only the changed digit of the time is different
+    setState(IDLE, 0, 126, 300);
+    display.printState();
+    checkFrame({5, 1, 1,
+                {"Mode   Beer Const.  ",
+                 "Beer              \xDF" "C",
+                 "Fridge            \xDF" "C",
+                 "Idling for     02m06"}});
+
+    display.printState();
+    checkNoFrame();
+
+    // the minimum on time counts down from 180 seconds
+    setState(COOLING_MIN_TIME, 60, 0, 300);
+    display.printState();
+    checkFrame({25, 24, 2,
+                {"Mode   Beer Const.  ",
+                 "Beer              \xDF" "C",
+                 "Fridge            \xDF" "C",
+                 "Cool time left 02m00"}});
+
+    // longer than an hour the hours are shown
+    setState(COOLING, 3725, 0, 300);
+    display.printState();
+    checkFrame({27, 22, 2,
+                {"Mode   Beer Const.  ",
+                 "Beer              \xDF" "C",
+                 "Fridge            \xDF" "C",
+                 "Cooling for  1h02m05"}});
+
+    // states without a time clear the whole line
+    setState(STATE_OFF, 0, 0, 0);
+    display.printState();
+    checkFrame({20, 19, 1,
+                {"Mode   Beer Const.  ",
+                 "Beer              \xDF" "C",
+                 "Fridge            \xDF" "C",
+                 "Temp. control OFF   "}});
+}
+
+void test_print_frame(void)
+{
+    startDisplay();
+    display.processQueue();
+
+    VirtualLcd &lcd = display.getLcd();
+    FILE *file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    VirtualLcd::printFrame(file, lcd.frame(lcd.frameCount() - 1));
+
+    char text[256];
+    size_t length = ftell(file);
+    rewind(file);
+    text[fread(text, 1, sizeof(text) - 1, file)] = '\0';
+    fclose(file);
+
+    char expected[256];
+    snprintf(expected, sizeof(expected), "frame t=%lu chars=58 changed=42 commands=8\n"
+                                         "|Mode   Beer Const.  |\n"
+                                         "|Beer              \xDF" "C|\n"
+                                         "|Fridge            \xDF" "C|\n"
+                                         "|Idling for     02m05|\n",
+             (unsigned long)ticks.millis());
+    TEST_ASSERT_EQUAL_UINT32(strlen(expected), length);
+    TEST_ASSERT_EQUAL_STRING(expected, text);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_print_mode);
+    RUN_TEST(test_print_state);
+    RUN_TEST(test_print_frame);
+    return UNITY_END();
+}